@@ -0,0 +1,1142 @@
+#include "contraction_hierarchy.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+
+#define INFINITE_LENGTH UINT_MAX
+
+/* Oznacza brak miasta. */
+#define NO_NODE UINT_MAX
+
+/* Na ile łuków hierarchii przypada co najwyżej jedno miasto lub odcinek
+ * grafu. W gęstszych grafach kontrakcja tworzy prawie pełne kliki i jest
+ * wolniejsza od zwykłego wyszukiwania. */
+#define MAX_FILL 16
+
+/* Ile przejrzanych sąsiadów i trójkątów przy budowie hierarchii przypada
+ * co najwyżej na jedno miasto lub odcinek grafu. Po przekroczeniu tej
+ * liczby budowa jest przerywana, nawet jeżeli łuków jest mniej niż
+ * pozwala MAX_FILL. */
+#define MAX_BUILD_WORK 4096
+
+/* Ranga pierwszego miasta w kolejności kontrakcji. Miasta dodane później
+ * dostają coraz niższe rangi. */
+#define FIRST_RANK (UINT_MAX / 2)
+
+/* Wartości tablicy dirty: trzeba przeliczyć łuki miasta z niezerowym polem
+ * dirty albo wszystkie łuki miasta. */
+#define DIRTY_ARCS 1
+#define DIRTY_ALL 2
+
+/* Bity pola dirty łuku: długość trzeba przeliczyć z trójkątów; długość
+ * zmalała, więc łuki od niej zależne trzeba sprawdzić. */
+#define ARC_RECOMPUTE 1
+#define ARC_DECREASED 2
+
+/* Dodaje długości, nie przekraczając INFINITE_LENGTH. */
+static unsigned add_lengths(unsigned l1, unsigned l2) {
+    if (l1 >= INFINITE_LENGTH - l2)
+        return INFINITE_LENGTH;
+
+    return l1 + l2;
+}
+
+/* Powiększa tablicę @p array tak, żeby mieściła co najmniej @p needed
+ * elementów rozmiaru @p size. */
+static bool reserve(void** array, size_t* capacity, size_t needed,
+                    size_t size) {
+    if (needed <= *capacity)
+        return true;
+
+    size_t new_capacity = *capacity ? 2 * *capacity : 8;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    void* bigger = realloc(*array, new_capacity * size);
+    if (!bigger)
+        return false;
+
+    *array = bigger;
+    *capacity = new_capacity;
+    return true;
+}
+
+static unsigned lower(contraction_hierarchy* ch, unsigned a, unsigned b) {
+    return ch->nodes[a].rank < ch->nodes[b].rank ? a : b;
+}
+
+static unsigned higher(contraction_hierarchy* ch, unsigned a, unsigned b) {
+    return ch->nodes[a].rank < ch->nodes[b].rank ? b : a;
+}
+
+/* Zwraca łuk z miasta @p a do miasta @p b o wyższej randze lub NULL. */
+static ch_arc* find_arc(contraction_hierarchy* ch, unsigned a, unsigned b) {
+    ch_node* node = &ch->nodes[a];
+
+    for (size_t i = 0; i < node->n_of_up; i++) {
+        if (node->up[i].head == b)
+            return &node->up[i];
+    }
+
+    return NULL;
+}
+
+static bool push_arc(contraction_hierarchy* ch, unsigned a, unsigned b) {
+    ch_node* node = &ch->nodes[a];
+    ch_node* head = &ch->nodes[b];
+
+    if (ch->n_of_arcs >= ch->max_arcs)
+        return false;
+
+    if (!reserve((void**)&node->up, &node->up_capacity, node->n_of_up + 1,
+                 sizeof(ch_arc)) ||
+        !reserve((void**)&head->down, &head->down_capacity,
+                 head->n_of_down + 1, sizeof(ch_down)))
+        return false;
+
+    head->down[head->n_of_down].tail = a;
+    head->down[head->n_of_down++].arc = (unsigned)node->n_of_up;
+
+    ch_arc* arc = &node->up[node->n_of_up++];
+    arc->head = b;
+    arc->length = INFINITE_LENGTH;
+    arc->road = NULL;
+    arc->mark = 0;
+    arc->dirty = ARC_RECOMPUTE;
+    ch->n_of_arcs++;
+
+    if (node->parent == NO_NODE || head->rank < ch->nodes[node->parent].rank)
+        node->parent = b;
+
+    return true;
+}
+
+static bool heap_push(contraction_hierarchy* ch, unsigned priority,
+                      unsigned city_id) {
+    if (!reserve((void**)&ch->heap, &ch->heap_capacity, ch->heap_size + 1,
+                 sizeof(unsigned long long)))
+        return false;
+
+    unsigned long long key = ((unsigned long long)priority << 32) | city_id;
+    size_t x = ch->heap_size++;
+
+    while (x > 0 && ch->heap[(x - 1) / 2] > key) {
+        ch->heap[x] = ch->heap[(x - 1) / 2];
+        x = (x - 1) / 2;
+    }
+    ch->heap[x] = key;
+
+    return true;
+}
+
+static unsigned long long heap_pop(contraction_hierarchy* ch) {
+    unsigned long long result = ch->heap[0];
+    unsigned long long key = ch->heap[--ch->heap_size];
+    size_t x = 0;
+
+    while (2 * x + 1 < ch->heap_size) {
+        size_t child = 2 * x + 1;
+        if (child + 1 < ch->heap_size && ch->heap[child + 1] < ch->heap[child])
+            child++;
+
+        if (ch->heap[child] >= key)
+            break;
+
+        ch->heap[x] = ch->heap[child];
+        x = child;
+    }
+    if (ch->heap_size > 0)
+        ch->heap[x] = key;
+
+    return result;
+}
+
+static bool stack_push(contraction_hierarchy* ch, unsigned a, unsigned b,
+                       unsigned c, unsigned d) {
+    if (!reserve((void**)&ch->stack, &ch->stack_capacity, ch->stack_size + 4,
+                 sizeof(unsigned)))
+        return false;
+
+    ch->stack[ch->stack_size++] = a;
+    ch->stack[ch->stack_size++] = b;
+    ch->stack[ch->stack_size++] = c;
+    ch->stack[ch->stack_size++] = d;
+
+    return true;
+}
+
+/* Powiększa tablice miast tak, żeby mieściły @p n miast. */
+static bool reserve_nodes(contraction_hierarchy* ch, size_t n) {
+    if (n <= ch->capacity)
+        return true;
+
+    size_t capacity = ch->capacity ? 2 * ch->capacity : 16;
+    while (capacity < n)
+        capacity *= 2;
+
+    ch_node* nodes = (ch_node*)realloc(ch->nodes, capacity * sizeof(ch_node));
+    if (!nodes)
+        return false;
+    ch->nodes = nodes;
+
+    unsigned** arrays[] = {
+        &ch->forward, &ch->backward, &ch->distance_f, &ch->distance_b,
+        &ch->rest_f, &ch->rest_b, &ch->triangle, &ch->triangle_length,
+        &ch->dirty, &ch->visited_f, &ch->visited_b
+    };
+
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+        unsigned* bigger = (unsigned*)realloc(*arrays[i],
+                                              capacity * sizeof(unsigned));
+        if (!bigger)
+            return false;
+
+        memset(bigger + ch->capacity, 0,
+               (capacity - ch->capacity) * sizeof(unsigned));
+        *arrays[i] = bigger;
+    }
+
+    ch->capacity = capacity;
+    return true;
+}
+
+/* Dodaje do hierarchii miasta o numerach Id od ch->n_of_nodes do
+ * n_of_cities - 1 z rangami niższymi od wszystkich dotychczasowych. Nowe
+ * miasto nie ma jeszcze łuków, więc może mieć dowolną rangę, a przy niskiej
+ * jego odcinki tworzą mało nowych łuków. */
+static bool add_nodes(contraction_hierarchy* ch, City** cities,
+                      size_t n_of_cities) {
+    if (!reserve_nodes(ch, n_of_cities))
+        return false;
+
+    for (; ch->n_of_nodes < n_of_cities; ch->n_of_nodes++) {
+        ch_node* node = &ch->nodes[ch->n_of_nodes];
+
+        node->city = cities[ch->n_of_nodes];
+        node->rank = --ch->lowest_rank;
+        node->parent = NO_NODE;
+        node->up = NULL;
+        node->n_of_up = node->up_capacity = 0;
+        node->down = NULL;
+        node->n_of_down = node->down_capacity = 0;
+    }
+
+    return true;
+}
+
+void free_contraction_hierarchy(contraction_hierarchy* ch) {
+    if (!ch)
+        return;
+
+    for (size_t i = 0; i < ch->n_of_nodes; i++) {
+        free(ch->nodes[i].up);
+        free(ch->nodes[i].down);
+    }
+
+    free(ch->nodes);
+    free(ch->forward);
+    free(ch->backward);
+    free(ch->distance_f);
+    free(ch->distance_b);
+    free(ch->rest_f);
+    free(ch->rest_b);
+    free(ch->triangle);
+    free(ch->triangle_length);
+    free(ch->dirty);
+    free(ch->previous);
+    free(ch->visited_f);
+    free(ch->visited_b);
+    free(ch->heap);
+    free(ch->stack);
+    free(ch->roads);
+    free(ch->sorted);
+    free(ch->order);
+    free(ch);
+}
+
+/* Rozpoczyna nowe zapytanie o trójkąty. */
+static void next_triangle_epoch(contraction_hierarchy* ch) {
+    if (++ch->triangle_epoch == 0) {
+        memset(ch->triangle, 0, ch->capacity * sizeof(unsigned));
+        ch->triangle_epoch = 1;
+    }
+}
+
+/* Rozpoczyna nowe zapytanie o najkrótsze drogi. */
+static void next_epoch(contraction_hierarchy* ch) {
+    if (++ch->epoch == 0) {
+        memset(ch->forward, 0, ch->capacity * sizeof(unsigned));
+        memset(ch->backward, 0, ch->capacity * sizeof(unsigned));
+        for (size_t i = 0; i < ch->n_of_nodes; i++) {
+            for (size_t j = 0; j < ch->nodes[i].n_of_up; j++)
+                ch->nodes[i].up[j].mark = 0;
+        }
+        ch->epoch = 1;
+    }
+}
+
+/* Usuwa z listy sąsiadów @p v w grafie eliminacji miasta wyeliminowane,
+ * a następnie dopisuje do niej brakujące miasta z @p clique. */
+static bool connect_clique(contraction_hierarchy* ch, unsigned** adj,
+                           size_t* n_of_adj, size_t* adj_capacity,
+                           const bool* eliminated, unsigned v,
+                           const unsigned* clique, size_t n_of_clique) {
+    size_t n = 0;
+
+    ch->work += n_of_adj[v] + n_of_clique;
+    next_triangle_epoch(ch);
+    for (size_t i = 0; i < n_of_adj[v]; i++) {
+        unsigned x = adj[v][i];
+
+        if (!eliminated[x] && ch->triangle[x] != ch->triangle_epoch) {
+            ch->triangle[x] = ch->triangle_epoch;
+            adj[v][n++] = x;
+        }
+    }
+    n_of_adj[v] = n;
+
+    for (size_t i = 0; i < n_of_clique; i++) {
+        unsigned x = clique[i];
+
+        if (x == v || ch->triangle[x] == ch->triangle_epoch)
+            continue;
+
+        if (!reserve((void**)&adj[v], &adj_capacity[v], n_of_adj[v] + 1,
+                     sizeof(unsigned)))
+            return false;
+
+        ch->triangle[x] = ch->triangle_epoch;
+        adj[v][n_of_adj[v]++] = x;
+    }
+
+    return true;
+}
+
+/* Przeszukuje wszerz miasta części @p part grafu eliminacji osiągalne
+ * z miasta @p source. Zapisuje je w @p queue w kolejności przeszukiwania,
+ * ich odległości od @p source w @p level i oznacza je bieżącym numerem
+ * zapytania o trójkąty. Zwraca liczbę osiągniętych miast. */
+static size_t level_structure(contraction_hierarchy* ch, unsigned** adj,
+                              const size_t* n_of_adj, const unsigned* part,
+                              unsigned source, unsigned* queue,
+                              unsigned* level) {
+    size_t n = 0;
+
+    next_triangle_epoch(ch);
+    ch->triangle[source] = ch->triangle_epoch;
+    level[source] = 0;
+    queue[n++] = source;
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned v = queue[i];
+
+        ch->work += n_of_adj[v];
+        for (size_t j = 0; j < n_of_adj[v]; j++) {
+            unsigned x = adj[v][j];
+
+            if (part[x] == part[v] && ch->triangle[x] != ch->triangle_epoch) {
+                ch->triangle[x] = ch->triangle_epoch;
+                level[x] = level[v] + 1;
+                queue[n++] = x;
+            }
+        }
+    }
+
+    return n;
+}
+
+/* Nadaje miastu @p v najwyższą wolną rangę i usuwa je z dzielonych części. */
+static void separate(contraction_hierarchy* ch, unsigned* part, unsigned v,
+                     unsigned* top) {
+    ch->nodes[v].rank = FIRST_RANK + --*top;
+    part[v] = NO_NODE;
+}
+
+/* Wyznacza rangi miast rekurencyjnym podziałem grafu (nested dissection).
+ * Część grafu zajmuje przedział tablicy @p perm, a jej miasta mają
+ * w @p part numer początku tego przedziału. Spójną część dzieli jedna
+ * z warstw przeszukiwania wszerz z pseudoperyferyjnego miasta, ograniczona
+ * do miast mających sąsiadów w następnej warstwie. Miasta separatora
+ * dostają najwyższe wolne rangi, a obie oddzielone części są dzielone
+ * dalej, więc łuki w górę miasta prowadzą tylko do separatorów części,
+ * które je zawierają. */
+static bool dissect(contraction_hierarchy* ch, unsigned** adj,
+                    const size_t* n_of_adj, unsigned* part, unsigned* perm,
+                    unsigned* queue, unsigned* level) {
+    unsigned top = (unsigned)ch->n_of_nodes;
+
+    for (unsigned v = 0; v < top; v++) {
+        perm[v] = v;
+        part[v] = 0;
+    }
+
+    ch->stack_size = 0;
+    if (top > 0 && !stack_push(ch, 0, top, 0, 0))
+        return false;
+
+    while (ch->stack_size > 0) {
+        if (ch->work > ch->max_work)
+            return false;
+
+        ch->stack_size -= 4;
+        unsigned lo = ch->stack[ch->stack_size];
+        unsigned hi = ch->stack[ch->stack_size + 1];
+        size_t n = level_structure(ch, adj, n_of_adj, part, perm[lo], queue,
+                                   level);
+
+        if (n < hi - lo) {
+            /* Część nie jest spójna: oddzielamy składową osiągniętą
+             * z pierwszego miasta od pozostałych miast. */
+            size_t k = n;
+
+            for (unsigned i = lo; i < hi; i++) {
+                unsigned v = perm[i];
+
+                if (ch->triangle[v] != ch->triangle_epoch) {
+                    queue[k++] = v;
+                    part[v] = lo + (unsigned)n;
+                }
+            }
+            memcpy(perm + lo, queue, (hi - lo) * sizeof(unsigned));
+
+            if (!stack_push(ch, lo, lo + (unsigned)n, 0, 0) ||
+                !stack_push(ch, lo + (unsigned)n, hi, 0, 0))
+                return false;
+            continue;
+        }
+
+        /* Najdalsze miasto od dowolnego jest zwykle końcem długiej drogi,
+         * więc przeszukiwanie z niego daje dużo wąskich warstw. */
+        n = level_structure(ch, adj, n_of_adj, part, queue[n - 1], queue,
+                            level);
+        unsigned depth = level[queue[n - 1]];
+
+        if (depth < 2) {
+            for (size_t i = 0; i < n; i++)
+                separate(ch, part, queue[i], &top);
+            continue;
+        }
+
+        /* Warstwy zajmują kolejne przedziały kolejki. Wybieramy najwęższą
+         * z nich, która zostawia po obu stronach co najmniej czwartą część
+         * miast, a jeżeli takiej nie ma, to warstwę środkowego miasta. */
+        unsigned middle = level[queue[(n - 1) / 2]];
+        size_t width = SIZE_MAX;
+
+        for (size_t i = 0, j; i < n; i = j) {
+            for (j = i; j < n && level[queue[j]] == level[queue[i]]; j++)
+                ;
+
+            if (4 * i >= n && 4 * (n - j) >= n && j - i < width) {
+                middle = level[queue[i]];
+                width = j - i;
+            }
+        }
+
+        if (middle == 0)
+            middle = 1;
+        else if (middle == depth)
+            middle = depth - 1;
+
+        for (size_t i = 0; i < n; i++) {
+            unsigned v = queue[i];
+
+            for (size_t j = 0; level[v] == middle && j < n_of_adj[v]; j++) {
+                unsigned x = adj[v][j];
+
+                if (part[x] == lo && level[x] == middle + 1)
+                    level[v] = NO_NODE;
+            }
+        }
+
+        unsigned k = lo;
+        for (size_t i = 0; i < n; i++) {
+            if (level[queue[i]] <= middle)
+                perm[k++] = queue[i];
+        }
+
+        unsigned split = k;
+        for (size_t i = 0; i < n; i++) {
+            unsigned v = queue[i];
+
+            if (level[v] > middle && level[v] != NO_NODE) {
+                perm[k++] = v;
+                part[v] = split;
+            }
+        }
+
+        if (!stack_push(ch, lo, split, 0, 0) ||
+            !stack_push(ch, split, k, 0, 0))
+            return false;
+
+        for (size_t i = 0; i < n; i++) {
+            if (level[queue[i]] == NO_NODE)
+                separate(ch, part, queue[i], &top);
+        }
+    }
+
+    return true;
+}
+
+/* Tworzy łuki w górę, eliminując miasta w kolejności rosnących rang:
+ * sąsiedzi eliminowanego miasta stają się jego łukami w górę i zostają
+ * połączeni w klikę. */
+static bool contract_all(contraction_hierarchy* ch) {
+    size_t n = ch->n_of_nodes;
+    unsigned** adj = (unsigned**)calloc(n ? n : 1, sizeof(unsigned*));
+    size_t* n_of_adj = (size_t*)calloc(n ? n : 1, sizeof(size_t));
+    size_t* adj_capacity = (size_t*)calloc(n ? n : 1, sizeof(size_t));
+    bool* eliminated = (bool*)calloc(n ? n : 1, sizeof(bool));
+    unsigned* scratch = (unsigned*)malloc(4 * (n ? n : 1) * sizeof(unsigned));
+    bool ok = adj && n_of_adj && adj_capacity && eliminated && scratch;
+
+    for (size_t v = 0; ok && v < n; v++) {
+        City* c = ch->nodes[v].city;
+
+        for (road_list* rl = c->roads; ok && rl; rl = rl->next_road) {
+            Road* road = rl->road;
+            City* next = (road->city1 == c) ? road->city2 : road->city1;
+
+            ok = reserve((void**)&adj[v], &adj_capacity[v], n_of_adj[v] + 1,
+                         sizeof(unsigned));
+            if (ok)
+                adj[v][n_of_adj[v]++] = next->city_id;
+        }
+    }
+
+    ok = ok && dissect(ch, adj, n_of_adj, scratch, scratch + n,
+                       scratch + 2 * n, scratch + 3 * n);
+
+    unsigned* by_rank = scratch;
+    for (size_t v = 0; ok && v < n; v++)
+        by_rank[ch->nodes[v].rank - FIRST_RANK] = (unsigned)v;
+
+    for (size_t r = 0; ok && r < n; r++) {
+        unsigned v = by_rank[r];
+
+        /* Lista sąsiadów jest aktualna: wyeliminowane miasta usuwa z niej
+         * connect_clique przy eliminacji każdego sąsiada. */
+        eliminated[v] = true;
+        for (size_t i = 0; ok && i < n_of_adj[v]; i++) {
+            unsigned x = adj[v][i];
+
+            ok = !eliminated[x] && push_arc(ch, v, x) &&
+                 connect_clique(ch, adj, n_of_adj, adj_capacity, eliminated,
+                                x, adj[v], n_of_adj[v]);
+        }
+
+        ok = ok && ch->work <= ch->max_work;
+    }
+    ch->lowest_rank = FIRST_RANK;
+
+    for (size_t v = 0; adj && v < n; v++)
+        free(adj[v]);
+    free(adj);
+    free(n_of_adj);
+    free(adj_capacity);
+    free(eliminated);
+    free(scratch);
+
+    return ok;
+}
+
+/* Zwraca łuk wskazany przez @p d. */
+static ch_arc* down_arc(contraction_hierarchy* ch, const ch_down* d) {
+    return &ch->nodes[d->tail].up[d->arc];
+}
+
+/* Oznacza, że łuki miasta @p a trzeba przeliczyć: oznaczone, gdy @p how
+ * jest równe DIRTY_ARCS, lub wszystkie, gdy jest równe DIRTY_ALL. */
+static bool mark_dirty(contraction_hierarchy* ch, unsigned a, unsigned how) {
+    unsigned old = ch->dirty[a];
+
+    if (how > old)
+        ch->dirty[a] = how;
+    if (old)
+        return true;
+
+    return heap_push(ch, ch->nodes[a].rank, a);
+}
+
+/* Wyznacza w tablicy triangle_length długości wszystkich łuków w górę
+ * miasta @p a na podstawie odcinków drogi i trójkątów z miastami o niższej
+ * randze. Łuki w górę każdego miasta @p w z tablicy down miasta @p a tworzą
+ * klikę, więc @p w wyznacza trójkąt z każdym łukiem z @p a do innego
+ * miasta z up(@p w) o wyższej randze. */
+static void node_triangles(contraction_hierarchy* ch, unsigned a) {
+    ch_node* node = &ch->nodes[a];
+
+    next_triangle_epoch(ch);
+    for (size_t i = 0; i < node->n_of_up; i++) {
+        ch_arc* arc = &node->up[i];
+
+        ch->triangle[arc->head] = ch->triangle_epoch;
+        ch->triangle_length[arc->head] =
+            arc->road ? arc->road->length : INFINITE_LENGTH;
+    }
+
+    for (size_t i = 0; i < node->n_of_down; i++) {
+        ch_node* w = &ch->nodes[node->down[i].tail];
+        unsigned to_a = down_arc(ch, &node->down[i])->length;
+
+        ch->work += w->n_of_up;
+        for (size_t j = 0; j < w->n_of_up; j++) {
+            unsigned x = w->up[j].head;
+
+            if (ch->triangle[x] == ch->triangle_epoch) {
+                unsigned l = add_lengths(to_a, w->up[j].length);
+                if (l < ch->triangle_length[x])
+                    ch->triangle_length[x] = l;
+            }
+        }
+    }
+}
+
+/* Zwraca długość łuku @p arc z miasta @p a wyznaczoną na podstawie odcinka
+ * drogi i trójkątów z miastami, z których prowadzą łuki do obu jego
+ * końców. Koszt jest proporcjonalny do liczby łuków w dół obu końców,
+ * a nie do liczby wszystkich trójkątów miasta @p a. */
+static unsigned arc_triangles(contraction_hierarchy* ch, unsigned a,
+                              ch_arc* arc) {
+    ch_node* node = &ch->nodes[a];
+    ch_node* head = &ch->nodes[arc->head];
+    unsigned length = arc->road ? arc->road->length : INFINITE_LENGTH;
+
+    ch->work += node->n_of_down + head->n_of_down;
+    next_triangle_epoch(ch);
+    for (size_t i = 0; i < head->n_of_down; i++) {
+        unsigned w = head->down[i].tail;
+
+        ch->triangle[w] = ch->triangle_epoch;
+        ch->triangle_length[w] = down_arc(ch, &head->down[i])->length;
+    }
+
+    for (size_t i = 0; i < node->n_of_down; i++) {
+        unsigned w = node->down[i].tail;
+
+        if (ch->triangle[w] == ch->triangle_epoch) {
+            unsigned l = add_lengths(down_arc(ch, &node->down[i])->length,
+                                     ch->triangle_length[w]);
+            if (l < length)
+                length = l;
+        }
+    }
+
+    return length;
+}
+
+/* Uaktualnia łuki zależne od łuków w górę miasta @p a, których długość
+ * się zmieniła, czyli tych z niezerowym polem dirty, a następnie zeruje to
+ * pole. Łuk pomiędzy sąsiadami @p y i @p z miasta @p a w górę tworzy
+ * trójkąt z łukami z @p a do @p y i do @p z. Jeżeli trójkąt się skrócił, to
+ * wystarczy skrócić łuk. Jeżeli się wydłużył, to łuk trzeba przeliczyć
+ * tylko wtedy, gdy nie był krótszy od trójkąta przed zmianą. */
+static bool mark_dependent(contraction_hierarchy* ch, unsigned a) {
+    ch_node* node = &ch->nodes[a];
+
+    next_triangle_epoch(ch);
+    for (size_t i = 0; i < node->n_of_up; i++) {
+        ch->triangle[node->up[i].head] = ch->triangle_epoch;
+        ch->triangle_length[node->up[i].head] = (unsigned)i;
+    }
+
+    for (size_t i = 0; i < node->n_of_up; i++) {
+        unsigned y = node->up[i].head;
+        ch_node* w = &ch->nodes[y];
+        bool marked = false;
+
+        if (ch->dirty[y] == DIRTY_ALL)
+            continue;
+
+        ch->work += w->n_of_up;
+        for (size_t j = 0; j < w->n_of_up; j++) {
+            ch_arc* arc = &w->up[j];
+            unsigned k = ch->triangle_length[arc->head];
+
+            if (ch->triangle[arc->head] != ch->triangle_epoch ||
+                (!node->up[i].dirty && !node->up[k].dirty))
+                continue;
+
+            unsigned before = add_lengths(ch->previous[i], ch->previous[k]);
+            unsigned after = add_lengths(node->up[i].length,
+                                         node->up[k].length);
+
+            if (after > before && arc->length >= before) {
+                arc->dirty |= ARC_RECOMPUTE;
+                marked = true;
+            }
+            else if (after < arc->length) {
+                arc->length = after;
+                arc->dirty |= ARC_DECREASED;
+                marked = true;
+            }
+        }
+
+        if (marked && !mark_dirty(ch, y, DIRTY_ARCS))
+            return false;
+    }
+
+    for (size_t i = 0; i < node->n_of_up; i++)
+        node->up[i].dirty = 0;
+
+    return true;
+}
+
+/* Przelicza długości łuków w górę miasta @p a: wszystkich, jeżeli @p how
+ * jest równe DIRTY_ALL lub jest to tańsze, a w przeciwnym wypadku tylko
+ * oznaczonych do przeliczenia. Po zmianie grafu zwykle zmienia się niewiele
+ * łuków miast o wysokich rangach, do których prowadzi bardzo dużo łuków
+ * w dół, więc przeliczanie pojedynczych łuków jest wtedy dużo szybsze. */
+static bool recontract(contraction_hierarchy* ch, unsigned a, unsigned how) {
+    ch_node* node = &ch->nodes[a];
+    size_t node_cost = 0, arcs_cost = 0;
+    bool changed = false;
+
+    if (!reserve((void**)&ch->previous, &ch->previous_capacity,
+                 node->n_of_up, sizeof(unsigned)))
+        return false;
+
+    for (size_t i = 0; how != DIRTY_ALL && i < node->n_of_down; i++)
+        node_cost += ch->nodes[node->down[i].tail].n_of_up;
+    for (size_t i = 0; how != DIRTY_ALL && i < node->n_of_up; i++) {
+        if (node->up[i].dirty & ARC_RECOMPUTE)
+            arcs_cost += node->n_of_down +
+                         ch->nodes[node->up[i].head].n_of_down;
+    }
+
+    bool all = how == DIRTY_ALL || node_cost <= arcs_cost;
+    if (all)
+        node_triangles(ch, a);
+
+    for (size_t i = 0; i < node->n_of_up; i++) {
+        ch_arc* arc = &node->up[i];
+
+        ch->previous[i] = arc->length;
+        if (all)
+            arc->length = ch->triangle_length[arc->head];
+        else if (arc->dirty & ARC_RECOMPUTE)
+            arc->length = arc_triangles(ch, a, arc);
+
+        /* Łuk skrócony przez mark_dependent zmienił się, nawet jeżeli
+         * przeliczenie dało jego obecną długość. Jego stara długość nie
+         * była mniejsza od zapamiętanej, więc mark_dependent co najwyżej
+         * przeliczy niepotrzebnie niektóre łuki. */
+        arc->dirty = (arc->dirty & ARC_DECREASED) ||
+                     arc->length != ch->previous[i];
+        changed = changed || arc->dirty;
+    }
+
+    return !changed || mark_dependent(ch, a);
+}
+
+/* Przelicza łuki oznaczonych miast w kolejności rosnących rang. */
+static bool recontract_dirty(contraction_hierarchy* ch) {
+    while (ch->heap_size > 0) {
+        unsigned a = (unsigned)heap_pop(ch);
+        unsigned how = ch->dirty[a];
+
+        ch->dirty[a] = 0;
+        if (!recontract(ch, a, how) || ch->work > ch->max_work)
+            return false;
+    }
+
+    return true;
+}
+
+contraction_hierarchy* build_contraction_hierarchy(City** cities,
+                                                   size_t n_of_cities,
+                                                   size_t n_of_roads) {
+    contraction_hierarchy* ch =
+        (contraction_hierarchy*)calloc(1, sizeof(contraction_hierarchy));
+    if (!ch)
+        return NULL;
+
+    ch->max_arcs = MAX_FILL * (n_of_cities + n_of_roads);
+    ch->max_work = MAX_BUILD_WORK * (n_of_cities + n_of_roads);
+    ch->lowest_rank = FIRST_RANK;
+
+    if (!add_nodes(ch, cities, n_of_cities) || !contract_all(ch)) {
+        free_contraction_hierarchy(ch);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n_of_cities; i++) {
+        City* c = cities[i];
+
+        for (road_list* rl = c->roads; rl; rl = rl->next_road) {
+            Road* road = rl->road;
+            unsigned a = road->city1->city_id, b = road->city2->city_id;
+            ch_arc* arc = find_arc(ch, lower(ch, a, b), higher(ch, a, b));
+
+            arc->road = road;
+        }
+    }
+
+    /* Przeliczenie wszystkich miast w kolejności rosnących rang wyznacza
+     * długości wszystkich łuków. */
+    for (size_t i = 0; i < n_of_cities; i++) {
+        if (!mark_dirty(ch, i, DIRTY_ALL)) {
+            free_contraction_hierarchy(ch);
+            return NULL;
+        }
+    }
+
+    if (!recontract_dirty(ch)) {
+        free_contraction_hierarchy(ch);
+        return NULL;
+    }
+
+    /* Zmiany grafu przeliczają tylko część łuków, więc ich nie ograniczamy. */
+    ch->max_work = SIZE_MAX;
+
+    return ch;
+}
+
+bool hierarchy_add_road(contraction_hierarchy* ch, City** cities,
+                        size_t n_of_cities, Road* road) {
+    if (!add_nodes(ch, cities, n_of_cities))
+        return false;
+
+    unsigned c1 = road->city1->city_id, c2 = road->city2->city_id;
+    ch->stack_size = 0;
+    if (!stack_push(ch, lower(ch, c1, c2), higher(ch, c1, c2), 0, 0))
+        return false;
+
+    /* Nowy łuk w górę miasta musi zostać połączony z jego pozostałymi
+     * łukami w górę, żeby nadal tworzyły klikę. */
+    while (ch->stack_size > 0) {
+        ch->stack_size -= 4;
+        unsigned a = ch->stack[ch->stack_size];
+        unsigned b = ch->stack[ch->stack_size + 1];
+
+        if (find_arc(ch, a, b))
+            continue;
+
+        if (!push_arc(ch, a, b) || !mark_dirty(ch, a, DIRTY_ARCS))
+            return false;
+
+        ch_node* node = &ch->nodes[a];
+        for (size_t i = 0; i + 1 < node->n_of_up; i++) {
+            unsigned x = node->up[i].head;
+
+            if (!stack_push(ch, lower(ch, x, b), higher(ch, x, b), 0, 0))
+                return false;
+        }
+    }
+
+    unsigned a = lower(ch, c1, c2);
+    ch_arc* arc = find_arc(ch, a, higher(ch, c1, c2));
+    arc->road = road;
+    arc->dirty = ARC_RECOMPUTE;
+
+    return mark_dirty(ch, a, DIRTY_ARCS) && recontract_dirty(ch);
+}
+
+bool hierarchy_remove_road(contraction_hierarchy* ch, City* city1,
+                           City* city2) {
+    unsigned c1 = city1->city_id, c2 = city2->city_id;
+    if (c1 >= ch->n_of_nodes || c2 >= ch->n_of_nodes)
+        return true;
+
+    unsigned a = lower(ch, c1, c2);
+    ch_arc* arc = find_arc(ch, a, higher(ch, c1, c2));
+    if (!arc)
+        return true;
+
+    arc->road = NULL;
+    arc->dirty = ARC_RECOMPUTE;
+
+    return mark_dirty(ch, a, DIRTY_ARCS) && recontract_dirty(ch);
+}
+
+/* Wyznacza odległości w górę od miasta @p source. Łuki w górę każdego
+ * miasta tworzą klikę, więc miasta osiągalne w górę leżą na ścieżce do
+ * korzenia w drzewie eliminacji, wyznaczonym przez pola parent. Przechodzimy
+ * ją w kolejności rosnących rang, więc odległość miasta jest ostateczna,
+ * gdy do niego dochodzimy, a osiągnięte miasta trafiają do @p visited w tej
+ * kolejności bez użycia kopca. Miasto jest wstrzymywane (stall-on-demand),
+ * gdy przez któregoś z jego sąsiadów w górę prowadzi do niego krótsza
+ * droga. Jego odległość nie jest wtedy długością najkrótszej drogi, więc
+ * nie leży ono na żadnej najkrótszej drodze: nie przeglądamy jego łuków
+ * i dalej traktujemy je jak nieosiągnięte. */
+static void upward_search(contraction_hierarchy* ch, unsigned source,
+                          unsigned* reached, unsigned* distance,
+                          unsigned* visited, size_t* n_of_visited) {
+    *n_of_visited = 0;
+    reached[source] = ch->epoch;
+    distance[source] = 0;
+
+    for (unsigned v = source; v != NO_NODE; v = ch->nodes[v].parent) {
+        ch_node* node = &ch->nodes[v];
+        bool stalled = false;
+
+        if (reached[v] != ch->epoch)
+            continue;
+
+        for (size_t i = 0; !stalled && i < node->n_of_up; i++) {
+            unsigned y = node->up[i].head;
+
+            stalled = reached[y] == ch->epoch &&
+                      add_lengths(distance[y], node->up[i].length) <
+                      distance[v];
+        }
+
+        if (stalled) {
+            reached[v] = 0;
+            continue;
+        }
+
+        visited[(*n_of_visited)++] = v;
+        for (size_t i = 0; i < node->n_of_up; i++) {
+            unsigned y = node->up[i].head;
+            unsigned l = add_lengths(distance[v], node->up[i].length);
+
+            if (l == INFINITE_LENGTH)
+                continue;
+
+            if (reached[y] != ch->epoch) {
+                reached[y] = ch->epoch;
+                distance[y] = l;
+            }
+            else if (l < distance[y]) {
+                distance[y] = l;
+            }
+        }
+    }
+}
+
+/* Wyznacza dla miast osiągniętych w górę od jednego końca długość
+ * najkrótszej drogi w górę, a następnie w dół do drugiego końca. Miasta
+ * w @p visited mają rosnące rangi, więc przeglądając je od końca, znamy już
+ * wyniki dla wszystkich sąsiadów w górę. */
+static void rest_lengths(contraction_hierarchy* ch, unsigned* visited,
+                         size_t n_of_visited, unsigned* reached,
+                         unsigned* other_reached, unsigned* other_distance,
+                         unsigned* rest) {
+    for (size_t i = n_of_visited; i-- > 0;) {
+        unsigned v = visited[i];
+        ch_node* node = &ch->nodes[v];
+
+        rest[v] = (other_reached[v] == ch->epoch) ? other_distance[v]
+                                                  : INFINITE_LENGTH;
+
+        for (size_t j = 0; j < node->n_of_up; j++) {
+            unsigned y = node->up[j].head;
+
+            if (reached[y] == ch->epoch) {
+                unsigned l = add_lengths(node->up[j].length, rest[y]);
+                if (l < rest[v])
+                    rest[v] = l;
+            }
+        }
+    }
+}
+
+/* Dodaje do stosu łuki z miast osiągniętych od jednego końca, które leżą
+ * na najkrótszych drogach. */
+static bool push_tight_arcs(contraction_hierarchy* ch, unsigned* visited,
+                            size_t n_of_visited, unsigned* reached,
+                            unsigned* distance, unsigned* rest,
+                            unsigned total, bool backward) {
+    for (size_t i = 0; i < n_of_visited; i++) {
+        unsigned v = visited[i];
+        ch_node* node = &ch->nodes[v];
+
+        if (add_lengths(distance[v], rest[v]) != total)
+            continue;
+
+        for (size_t j = 0; j < node->n_of_up; j++) {
+            unsigned y = node->up[j].head;
+            unsigned length = node->up[j].length;
+
+            if (reached[y] != ch->epoch ||
+                add_lengths(add_lengths(distance[v], length), rest[y]) != total)
+                continue;
+
+            bool ok = backward ?
+                stack_push(ch, v, j, y, total - distance[v] - length) :
+                stack_push(ch, v, j, v, distance[v]);
+            if (!ok)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool push_road(contraction_hierarchy* ch, unsigned from, unsigned to,
+                      unsigned distance, Road* road) {
+    if (!reserve((void**)&ch->roads, &ch->roads_capacity, ch->n_of_roads + 1,
+                 sizeof(shortest_road)))
+        return false;
+
+    shortest_road* r = &ch->roads[ch->n_of_roads++];
+    r->from = ch->nodes[from].city;
+    r->to = ch->nodes[to].city;
+    r->distance = distance;
+    r->road = road;
+
+    return true;
+}
+
+/* Rozwija łuki ze stosu na odcinki drogi. Łuk leżący na najkrótszej drodze
+ * odpowiada odcinkowi drogi oraz wszystkim trójkątom z miastami o niższej
+ * randze, które mają tę samą długość. */
+static bool unpack_arcs(contraction_hierarchy* ch) {
+    while (ch->stack_size > 0) {
+        ch->stack_size -= 4;
+        unsigned a = ch->stack[ch->stack_size];
+        ch_arc* arc = &ch->nodes[a].up[ch->stack[ch->stack_size + 1]];
+        unsigned from = ch->stack[ch->stack_size + 2];
+        unsigned distance = ch->stack[ch->stack_size + 3];
+
+        if (arc->mark == ch->epoch)
+            continue;
+        arc->mark = ch->epoch;
+
+        unsigned b = arc->head;
+        unsigned to = (from == a) ? b : a;
+
+        if (arc->road && arc->road->length == arc->length &&
+            !push_road(ch, from, to, distance + arc->length, arc->road))
+            return false;
+
+        ch_node* node = &ch->nodes[a];
+        ch_node* head = &ch->nodes[b];
+
+        next_triangle_epoch(ch);
+        for (size_t i = 0; i < head->n_of_down; i++) {
+            ch->triangle[head->down[i].tail] = ch->triangle_epoch;
+            ch->triangle_length[head->down[i].tail] = head->down[i].arc;
+        }
+
+        for (size_t i = 0; i < node->n_of_down; i++) {
+            unsigned w = node->down[i].tail;
+
+            if (ch->triangle[w] != ch->triangle_epoch)
+                continue;
+
+            ch_arc* up = ch->nodes[w].up;
+            ch_arc* to_a = &up[node->down[i].arc];
+            ch_arc* to_b = &up[ch->triangle_length[w]];
+
+            if (add_lengths(to_a->length, to_b->length) != arc->length)
+                continue;
+
+            ch_arc* to_from = (from == a) ? to_a : to_b;
+            ch_arc* to_to = (from == a) ? to_b : to_a;
+
+            if (!stack_push(ch, w, to_from - up, from, distance) ||
+                !stack_push(ch, w, to_to - up, w, distance + to_from->length))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/* Ustawia odcinki z tablicy roads tak, że każdy odcinek występuje po
+ * wszystkich odcinkach kończących się w jego bliższym końcu. Długości
+ * odcinków są dodatnie, więc odcinki tworzą graf acykliczny, a kolejność
+ * wyznacza algorytm Kahna w czasie liniowym. Miasta dostają kolejne numery
+ * w tablicy triangle_length. */
+static bool order_roads(contraction_hierarchy* ch) {
+    size_t n = ch->n_of_roads;
+
+    if (!reserve((void**)&ch->order, &ch->order_capacity, 7 * n + 1,
+                 sizeof(unsigned)) ||
+        !reserve((void**)&ch->sorted, &ch->sorted_capacity, n,
+                 sizeof(shortest_road)))
+        return false;
+
+    /* Dla każdego miasta liczba nieustawionych odcinków do niego i lista
+     * odcinków z niego, a dla miast bez nieustawionych odcinków kolejka. */
+    unsigned* in = ch->order;
+    unsigned* first = in + 2 * n;
+    unsigned* next = first + 2 * n;
+    unsigned* queue = next + n;
+    unsigned n_of_ids = 0;
+
+    next_triangle_epoch(ch);
+    for (size_t i = 0; i < n; i++) {
+        City* ends[] = {ch->roads[i].from, ch->roads[i].to};
+
+        for (size_t j = 0; j < 2; j++) {
+            unsigned c = ends[j]->city_id;
+
+            if (ch->triangle[c] != ch->triangle_epoch) {
+                ch->triangle[c] = ch->triangle_epoch;
+                ch->triangle_length[c] = n_of_ids;
+                in[n_of_ids] = 0;
+                first[n_of_ids++] = NO_NODE;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned a = ch->triangle_length[ch->roads[i].from->city_id];
+
+        in[ch->triangle_length[ch->roads[i].to->city_id]]++;
+        next[i] = first[a];
+        first[a] = (unsigned)i;
+    }
+
+    size_t head = 0, tail = 0, k = 0;
+    for (unsigned c = 0; c < n_of_ids; c++) {
+        if (in[c] == 0)
+            queue[tail++] = c;
+    }
+
+    while (head < tail) {
+        for (unsigned i = first[queue[head++]]; i != NO_NODE; i = next[i]) {
+            unsigned b = ch->triangle_length[ch->roads[i].to->city_id];
+
+            ch->sorted[k++] = ch->roads[i];
+            if (--in[b] == 0)
+                queue[tail++] = b;
+        }
+    }
+
+    shortest_road* roads = ch->roads;
+    size_t capacity = ch->roads_capacity;
+    ch->roads = ch->sorted;
+    ch->roads_capacity = ch->sorted_capacity;
+    ch->sorted = roads;
+    ch->sorted_capacity = capacity;
+
+    return true;
+}
+
+bool hierarchy_shortest_roads(contraction_hierarchy* ch, City* c_pocz,
+                              City* c_kon) {
+    unsigned s = c_pocz->city_id, t = c_kon->city_id;
+
+    ch->n_of_roads = 0;
+    if (s >= ch->n_of_nodes || t >= ch->n_of_nodes)
+        return true;
+
+    next_epoch(ch);
+    upward_search(ch, s, ch->forward, ch->distance_f, ch->visited_f,
+                  &ch->n_of_visited_f);
+    upward_search(ch, t, ch->backward, ch->distance_b, ch->visited_b,
+                  &ch->n_of_visited_b);
+    rest_lengths(ch, ch->visited_f, ch->n_of_visited_f, ch->forward,
+                 ch->backward, ch->distance_b, ch->rest_f);
+    rest_lengths(ch, ch->visited_b, ch->n_of_visited_b, ch->backward,
+                 ch->forward, ch->distance_f, ch->rest_b);
+
+    unsigned total = ch->rest_f[s];
+    if (total == INFINITE_LENGTH)
+        return true;
+
+    ch->stack_size = 0;
+    if (!push_tight_arcs(ch, ch->visited_f, ch->n_of_visited_f, ch->forward,
+                         ch->distance_f, ch->rest_f, total, false) ||
+        !push_tight_arcs(ch, ch->visited_b, ch->n_of_visited_b, ch->backward,
+                         ch->distance_b, ch->rest_b, total, true) ||
+        !unpack_arcs(ch))
+        return false;
+
+    return order_roads(ch);
+}
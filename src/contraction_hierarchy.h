@@ -0,0 +1,184 @@
+/** @file
+ * Biblioteka definiująca hierarchię skrótów (contraction hierarchy) nad
+ * grafem dróg, pozwalającą szybko znaleźć wszystkie najkrótsze drogi
+ * pomiędzy dwoma miastami.
+ */
+
+#ifndef DROGI_CONTRACTION_HIERARCHY_H
+#define DROGI_CONTRACTION_HIERARCHY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+
+/** @brief Typ danych przechowujący łuk hierarchii.
+ * Łuk prowadzi od miasta o niższej randze do miasta o wyższej randze.
+ * Jego długość jest długością najkrótszej drogi pomiędzy tymi miastami,
+ * która poza końcami przechodzi tylko przez miasta o niższych rangach.
+ */
+typedef struct ch_arc {
+    unsigned head; ///< Numer Id miasta o wyższej randze
+    unsigned length; ///< Długość łuku lub UINT_MAX, gdy nie ma takiej drogi
+    Road* road; ///< Odcinek drogi łączący końce łuku lub NULL
+    unsigned mark; ///< Numer zapytania, w którym rozwinięto łuk
+    unsigned dirty; ///< Czy długość łuku trzeba przeliczyć (1), czy już
+    ///< zmalała przy przeliczaniu miasta o niższej randze (2)
+} ch_arc;
+
+/** @brief Typ danych wskazujący łuk prowadzący w dół od miasta.
+ */
+typedef struct ch_down {
+    unsigned tail; ///< Numer Id miasta o niższej randze
+    unsigned arc; ///< Numer łuku w tablicy łuków w górę miasta @p tail
+} ch_down;
+
+/** @brief Typ danych przechowujący miasto w hierarchii.
+ * Łuki w górę miasta tworzą klikę w grafie z łukami hierarchii, więc
+ * hierarchia zawiera wszystkie skróty, a nie tylko te, które nie mają
+ * krótszej drogi zastępczej. Dzięki temu jej kształt nie zależy od długości
+ * odcinków i po zmianie grafu wystarczy przeliczyć długości części łuków.
+ */
+typedef struct ch_node {
+    City* city; ///< Miasto
+    unsigned rank; ///< Ranga miasta, czyli numer w kolejności kontrakcji
+    unsigned parent; ///< Numer Id sąsiada w górę o najniższej randze lub
+    ///< UINT_MAX, gdy miasto nie ma łuków w górę
+    ch_arc* up; ///< Łuki do miast o wyższej randze
+    size_t n_of_up; ///< Liczba łuków w górę
+    size_t up_capacity; ///< Liczba miejsc w tablicy @p up
+    ch_down* down; ///< Łuki prowadzące do tego miasta
+    size_t n_of_down; ///< Liczba łuków w tablicy @p down
+    size_t down_capacity; ///< Liczba miejsc w tablicy @p down
+} ch_node;
+
+/** @brief Typ danych opisujący odcinek drogi leżący na najkrótszej drodze.
+ */
+typedef struct shortest_road {
+    City* from; ///< Miasto bliższe miasta początkowego
+    City* to; ///< Miasto dalsze od miasta początkowego
+    unsigned distance; ///< Długość najkrótszej drogi do miasta @p to
+    Road* road; ///< Odcinek drogi pomiędzy @p from i @p to
+} shortest_road;
+
+/** @brief Typ danych przechowujący hierarchię skrótów.
+ * Tablice indeksowane są numerami Id miast. Pola oznaczone numerem
+ * zapytania są ważne tylko wtedy, gdy ten numer jest równy @p epoch.
+ */
+typedef struct contraction_hierarchy {
+    size_t n_of_nodes; ///< Liczba miast w hierarchii
+    size_t capacity; ///< Liczba miejsc w tablicach miast
+    unsigned lowest_rank; ///< Ranga ostatnio dodanego miasta, niższa od
+    ///< rang wszystkich pozostałych
+    ch_node* nodes; ///< Miasta hierarchii
+    size_t n_of_arcs; ///< Liczba łuków hierarchii
+    size_t max_arcs; ///< Największa dopuszczalna liczba łuków
+    size_t work; ///< Liczba przejrzanych sąsiadów i trójkątów
+    size_t max_work; ///< Największa dopuszczalna wartość @p work; ogranicza
+    ///< tylko budowę hierarchii
+    unsigned epoch; ///< Numer bieżącego zapytania
+    unsigned* forward; ///< Numer zapytania, w którym dotarto do miasta
+    ///< w górę od miasta początkowego
+    unsigned* backward; ///< To samo dla miasta końcowego
+    unsigned* distance_f; ///< Odległość od miasta początkowego w górę
+    unsigned* distance_b; ///< Odległość od miasta końcowego w górę
+    unsigned* rest_f; ///< Najkrótsza droga w górę i w dół do miasta
+    ///< końcowego
+    unsigned* rest_b; ///< Najkrótsza droga w górę i w dół do miasta
+    ///< początkowego
+    unsigned triangle_epoch; ///< Numer bieżącego zapytania o trójkąty
+    unsigned* triangle; ///< Numer zapytania o trójkąty, w którym oznaczono
+    ///< miasto
+    unsigned* triangle_length; ///< Długość łuku do oznaczonego miasta
+    unsigned* dirty; ///< Czy trzeba przeliczyć długości oznaczonych łuków
+    ///< miasta (1), czy wszystkich (2)
+    unsigned* previous; ///< Długości łuków przeliczanego miasta przed
+    ///< przeliczeniem
+    size_t previous_capacity; ///< Liczba miejsc w tablicy @p previous
+    unsigned* visited_f; ///< Miasta osiągnięte w górę od miasta początkowego
+    ///< i niewstrzymane, w kolejności rosnących rang
+    size_t n_of_visited_f; ///< Liczba miast w tablicy @p visited_f
+    unsigned* visited_b; ///< To samo dla miasta końcowego
+    size_t n_of_visited_b; ///< Liczba miast w tablicy @p visited_b
+    unsigned long long* heap; ///< Kopiec par (priorytet, numer Id miasta)
+    size_t heap_size; ///< Liczba elementów kopca
+    size_t heap_capacity; ///< Liczba miejsc w tablicy @p heap
+    unsigned* stack; ///< Stos czwórek liczb używany przy podziale grafu,
+    ///< rozwijaniu łuków i dodawaniu łuków
+    size_t stack_size; ///< Liczba liczb na stosie
+    size_t stack_capacity; ///< Liczba miejsc w tablicy @p stack
+    shortest_road* roads; ///< Odcinki na najkrótszych drogach
+    size_t n_of_roads; ///< Liczba odcinków w tablicy @p roads
+    size_t roads_capacity; ///< Liczba miejsc w tablicy @p roads
+    shortest_road* sorted; ///< Odcinki ustawiane w kolejności topologicznej
+    size_t sorted_capacity; ///< Liczba miejsc w tablicy @p sorted
+    unsigned* order; ///< Liczniki i listy używane przy ustawianiu odcinków
+    size_t order_capacity; ///< Liczba miejsc w tablicy @p order
+} contraction_hierarchy;
+
+/** @brief Buduje hierarchię skrótów dla grafu dróg.
+ * Kolejność kontrakcji wyznacza rekurencyjny podział grafu (nested
+ * dissection): miasta małego separatora dostają rangi wyższe od obu
+ * oddzielonych części. Liczba łuków hierarchii i praca wykonana przy jej
+ * budowie są ograniczone przez stałe krotności rozmiaru grafu, bo w grafach
+ * bez małych separatorów hierarchia się nie opłaca. Budowa jest wtedy
+ * przerywana po czasie liniowym względem rozmiaru grafu.
+ * @param [in] cities       - Tablica miast w kolejności numerów Id;
+ * @param [in] n_of_cities  - Liczba miast;
+ * @param [in] n_of_roads   - Liczba odcinków dróg.
+ * @return Zwraca wskaźnik na hierarchię lub NULL, gdy nie udało się
+ * zaalokować pamięci lub hierarchia miałaby za dużo łuków.
+ */
+contraction_hierarchy* build_contraction_hierarchy(City** cities,
+                                                   size_t n_of_cities,
+                                                   size_t n_of_roads);
+
+/** @brief Usuwa hierarchię skrótów.
+ * Nic nie robi, jeżeli @p ch ma wartość NULL.
+ * @param [in, out] ch      - Wskaźnik na hierarchię.
+ */
+void free_contraction_hierarchy(contraction_hierarchy* ch);
+
+/** @brief Dodaje do hierarchii nowy odcinek drogi.
+ * Dodaje do hierarchii miasta, których jeszcze w niej nie ma, oraz brakujące
+ * łuki, a następnie przelicza długości łuków, które mogły się zmienić.
+ * @param [in, out] ch      - Wskaźnik na hierarchię;
+ * @param [in] cities       - Tablica miast w kolejności numerów Id;
+ * @param [in] n_of_cities  - Liczba miast;
+ * @param [in] road         - Dodany odcinek drogi.
+ * @return Zwraca @p true jeżeli udało się uaktualnić hierarchię, @p false
+ * jeżeli nie udało się zaalokować pamięci lub hierarchia miałaby za dużo
+ * łuków. Hierarchii nie można wtedy dalej używać.
+ */
+bool hierarchy_add_road(contraction_hierarchy* ch, City** cities,
+                        size_t n_of_cities, Road* road);
+
+/** @brief Usuwa z hierarchii odcinek drogi.
+ * Przelicza długości łuków, które mogły się zmienić. Łuki pozostają
+ * w hierarchii.
+ * @param [in, out] ch      - Wskaźnik na hierarchię;
+ * @param [in] city1        - Wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] city2        - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca @p true jeżeli udało się uaktualnić hierarchię, @p false
+ * jeżeli nie udało się zaalokować pamięci. Hierarchii nie można wtedy
+ * dalej używać.
+ */
+bool hierarchy_remove_road(contraction_hierarchy* ch, City* city1,
+                           City* city2);
+
+/** @brief Znajduje wszystkie odcinki leżące na najkrótszych drogach.
+ * Wyznacza w @p ch->roads wszystkie odcinki drogi leżące na którejś
+ * z najkrótszych dróg z @p c_pocz do @p c_kon, ustawione tak, że każdy
+ * odcinek występuje po wszystkich odcinkach kończących się w jego bliższym
+ * końcu. Nie ma ich, jeżeli miasta nie są połączone. Koszt zapytania jest
+ * proporcjonalny do liczby łuków w górę przodków obu miast w drzewie
+ * eliminacji.
+ * @param [in, out] ch      - Wskaźnik na hierarchię;
+ * @param [in] c_pocz       - Wskaźnik na miasto początkowe;
+ * @param [in] c_kon        - Wskaźnik na miasto końcowe różne od @p c_pocz.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+bool hierarchy_shortest_roads(contraction_hierarchy* ch, City* c_pocz,
+                              City* c_kon);
+
+#endif //DROGI_CONTRACTION_HIERARCHY_H
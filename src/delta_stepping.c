@@ -0,0 +1,362 @@
+#include "delta_stepping.h"
+#include "priority_queue.h"
+#include <stdlib.h>
+#include <limits.h>
+
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+
+/* Mniejsze partie miast przegląda sam wątek wywołujący, bo podzielenie ich
+ * pomiędzy wątki kosztowałoby więcej niż ich przejrzenie. */
+#define PARALLEL_THRESHOLD 256
+
+/* Partia jest dzielona na więcej zadań niż wątków, żeby miasta o wielu
+ * odcinkach nie obciążały jednego wątku. */
+#define TASKS_PER_WORKER 4
+
+/* Wyszukiwanie używa tablic pamięci roboczej: length i reached dla długości
+ * najkrótszych dróg, settled_back dla miast odwiedzonych w zakończonych lub
+ * bieżącym kubełku, a reached_back dla miast, dla których trzeba wyznaczyć
+ * rok remontu. */
+
+/** @brief Typ danych opisujący krótszą drogę do miasta.
+ */
+typedef struct relaxation {
+    unsigned city; ///< Numer Id miasta
+    unsigned length; ///< Długość drogi
+} relaxation;
+
+/** @brief Typ danych przechowujący krótsze drogi znalezione przez wątek.
+ */
+typedef struct relaxations {
+    relaxation* items; ///< Znalezione drogi
+    size_t size; ///< Liczba znalezionych dróg
+    size_t capacity; ///< Liczba dróg, na które zaalokowano miejsce
+    size_t work; ///< Liczba przejrzanych miast i odcinków
+    bool memory_error; ///< Czy zabrakło pamięci
+} relaxations;
+
+/** @brief Typ danych opisujący bieżące wyszukiwanie.
+ */
+typedef struct delta_search {
+    search_workspace* ws; ///< Pamięć robocza
+    graph_snapshot* g; ///< Migawka grafu
+    City* c_kon; ///< Miasto końcowe
+    unsigned delta; ///< Szerokość kubełka i największa długość lekkiego
+    ///< odcinka
+    unsigned* sources; ///< Miasta, których odcinki są przeglądane
+    size_t n_of_sources; ///< Liczba miast w @p sources
+    size_t part_size; ///< Liczba miast przeglądanych przez jedno zadanie
+    bool light; ///< Czy przeglądane są lekkie, czy ciężkie odcinki
+    relaxations* found; ///< Drogi znalezione przez kolejne wątki
+} delta_search;
+
+/** @brief Dopisuje krótszą drogę do miasta.
+ * @param [in, out] r       - Drogi znalezione przez wątek;
+ * @param [in] city         - Numer Id miasta;
+ * @param [in] length       - Długość drogi.
+ */
+static void push_relaxation(relaxations* r, unsigned city, unsigned length) {
+    if (r->size == r->capacity) {
+        size_t capacity = r->capacity ? 2 * r->capacity : 64;
+        relaxation* items = (relaxation*)realloc(r->items, capacity *
+                                                 sizeof(relaxation));
+        if (!items) {
+            r->memory_error = true;
+            return;
+        }
+
+        r->items = items;
+        r->capacity = capacity;
+    }
+
+    r->items[r->size].city = city;
+    r->items[r->size].length = length;
+    r->size++;
+}
+
+/** @brief Przegląda odcinki wychodzące z części miast partii.
+ * Tylko czyta pamięć roboczą, więc zadania mogą być wykonywane równolegle.
+ * @param [in, out] arg     - Wskaźnik na opis wyszukiwania;
+ * @param [in] worker       - Numer wątku;
+ * @param [in] part         - Numer części partii.
+ */
+static void relax_part(void* arg, size_t worker, size_t part) {
+    delta_search* s = (delta_search*)arg;
+    search_workspace* ws = s->ws;
+    graph_snapshot* g = s->g;
+    relaxations* r = &s->found[worker];
+    size_t from = part * s->part_size;
+    size_t to = MIN(from + s->part_size, s->n_of_sources);
+
+    for (size_t i = from; i < to && !r->memory_error; i++) {
+        unsigned c = s->sources[i];
+        if (g->cities[c] == s->c_kon)
+            continue;
+
+        unsigned length = ws->length[c];
+        r->work += g->offset[c + 1] - g->offset[c] + 1;
+
+        for (size_t x = g->offset[c]; x < g->offset[c + 1]; x++) {
+            unsigned next = g->neighbour[x];
+
+            if ((g->length[x] <= s->delta) != s->light)
+                continue;
+
+            if (ws->excluded[next] == ws->epoch && g->cities[next] != s->c_kon)
+                continue;
+
+            if (ws->reached[next] == ws->epoch &&
+                ws->length[next] <= length + g->length[x])
+                continue;
+
+            push_relaxation(r, next, length + g->length[x]);
+        }
+    }
+}
+
+/** @brief Przegląda odcinki wychodzące z miast partii i zapisuje znalezione
+ * krótsze drogi.
+ * @param [in, out] s       - Opis wyszukiwania;
+ * @param [in, out] pool    - Pula wątków lub NULL;
+ * @param [in] sources      - Miasta partii;
+ * @param [in] n            - Liczba miast partii;
+ * @param [in] light        - Czy przeglądać lekkie, czy ciężkie odcinki.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool relax_batch(delta_search* s, worker_pool* pool,
+                        unsigned* sources, size_t n, bool light) {
+    search_workspace* ws = s->ws;
+    size_t n_of_workers = pool ? worker_count(pool) : 1;
+
+    if (n == 0)
+        return true;
+
+    s->sources = sources;
+    s->n_of_sources = n;
+    s->light = light;
+
+    if (!pool || n < PARALLEL_THRESHOLD) {
+        s->part_size = n;
+        relax_part(s, 0, 0);
+    }
+    else {
+        size_t parts = TASKS_PER_WORKER * n_of_workers;
+        s->part_size = (n + parts - 1) / parts;
+        run_tasks(pool, relax_part, s, (n + s->part_size - 1) / s->part_size);
+    }
+
+    bool ok = true;
+    for (size_t w = 0; w < n_of_workers; w++) {
+        relaxations* r = &s->found[w];
+        ok = ok && !r->memory_error;
+
+        for (size_t i = 0; ok && i < r->size; i++) {
+            unsigned c = r->items[i].city;
+            unsigned length = r->items[i].length;
+
+            if (ws->reached[c] == ws->epoch && ws->length[c] <= length)
+                continue;
+
+            ws->reached[c] = ws->epoch;
+            ws->length[c] = length;
+            ok = add(ws->queue, make_path(s->g->cities[c], 1, length));
+        }
+
+        ws->work += r->work;
+        r->work = 0;
+        r->size = 0;
+    }
+
+    return ok;
+}
+
+/** @brief Wyznacza długości najkrótszych dróg z miasta początkowego.
+ * Kończy się po odwiedzeniu kubełka zawierającego miasto końcowe, kiedy
+ * długości dróg do wszystkich miast, przez które mogą prowadzić najkrótsze
+ * drogi do niego, są już ostateczne.
+ * @param [in, out] s       - Opis wyszukiwania;
+ * @param [in, out] pool    - Pula wątków lub NULL;
+ * @param [out] frontier    - Tablica na miasta zdjęte z kolejki;
+ * @param [out] bucket      - Tablica na miasta bieżącego kubełka.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool find_lengths(delta_search* s, worker_pool* pool,
+                         unsigned* frontier, unsigned* bucket) {
+    search_workspace* ws = s->ws;
+    priority_queue* q = ws->queue;
+    bool ok = true;
+
+    while (ok && !is_empty(q) &&
+           ws->settled_back[s->c_kon->city_id] != ws->epoch) {
+        unsigned b = top(q).total_length / s->delta;
+        size_t n_of_bucket = 0;
+
+        /* Lekkie odcinki mogą prowadzić do tego samego kubełka, więc jego
+         * miasta są przeglądane, dopóki drogi do nich się skracają. */
+        while (ok && !is_empty(q) && top(q).total_length / s->delta == b) {
+            size_t n = 0;
+
+            while (!is_empty(q) && top(q).total_length / s->delta == b) {
+                unsigned c = pop(q).city_id;
+
+                frontier[n++] = c;
+                if (ws->settled_back[c] != ws->epoch) {
+                    ws->settled_back[c] = ws->epoch;
+                    bucket[n_of_bucket++] = c;
+                }
+            }
+
+            ok = relax_batch(s, pool, frontier, n, true);
+        }
+
+        ok = ok && relax_batch(s, pool, bucket, n_of_bucket, false);
+    }
+
+    return ok;
+}
+
+/** @brief Sprawdza, czy najkrótsza droga do miasta może prowadzić przez
+ * jego sąsiada.
+ * @param [in] ws           - Pamięć robocza;
+ * @param [in] g            - Migawka grafu;
+ * @param [in] c            - Numer Id miasta;
+ * @param [in] x            - Odcinek drogi wychodzący z @p c.
+ * @return Zwraca @p true jeżeli droga do sąsiada przedłużona odcinkiem
+ * @p x jest najkrótszą drogą do @p c.
+ */
+static bool is_tight(search_workspace* ws, graph_snapshot* g, unsigned c,
+                     size_t x) {
+    unsigned next = g->neighbour[x];
+
+    return ws->reached[next] == ws->epoch &&
+           ws->length[next] + g->length[x] == ws->length[c];
+}
+
+/** @brief Wyznacza najlepszą drogę do miasta spośród najkrótszych.
+ * Lata remontów muszą być już wyznaczone dla wszystkich sąsiadów, przez
+ * których prowadzą najkrótsze drogi do miasta.
+ * @param [in, out] ws      - Pamięć robocza;
+ * @param [in] g            - Migawka grafu;
+ * @param [in] c            - Numer Id miasta różnego od początkowego.
+ */
+static void resolve_city(search_workspace* ws, graph_snapshot* g,
+                         unsigned c) {
+    size_t n_of_best = 0;
+    int best = 0;
+
+    for (size_t x = g->offset[c]; x < g->offset[c + 1]; x++) {
+        if (!is_tight(ws, g, c, x))
+            continue;
+
+        unsigned next = g->neighbour[x];
+        int repair = MIN(ws->repair[next], g->repair_year[x]);
+
+        if (n_of_best == 0 || repair > best) {
+            best = repair;
+            n_of_best = 1;
+            ws->previous_city[c] = g->cities[next];
+        }
+        else if (repair == best) {
+            n_of_best++;
+        }
+    }
+
+    ws->repair[c] = best;
+    ws->only_one_path[c] = n_of_best == 1;
+}
+
+/** @brief Wyznacza lata remontów i jednoznaczność najlepszych dróg.
+ * Rozpatruje tylko miasta, przez które prowadzą najkrótsze drogi do miasta
+ * końcowego, w kolejności długości dróg do nich, więc zawsze po ich
+ * poprzednikach na tych drogach.
+ * @param [in, out] s       - Opis wyszukiwania;
+ * @param [in] c_pocz       - Miasto początkowe;
+ * @param [out] stack       - Tablica na miasta odłożone na stos.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool resolve_repairs(delta_search* s, City* c_pocz, unsigned* stack) {
+    search_workspace* ws = s->ws;
+    graph_snapshot* g = s->g;
+    priority_queue* q = ws->queue;
+    size_t n = 0;
+    bool ok = true;
+
+    clear_priority_queue(q);
+    stack[n++] = s->c_kon->city_id;
+    ws->reached_back[s->c_kon->city_id] = ws->epoch;
+
+    while (ok && n > 0) {
+        unsigned c = stack[--n];
+        ok = add(q, make_path(g->cities[c], 1, ws->length[c]));
+
+        for (size_t x = g->offset[c]; x < g->offset[c + 1]; x++) {
+            unsigned next = g->neighbour[x];
+
+            if (is_tight(ws, g, c, x) && ws->reached_back[next] != ws->epoch) {
+                ws->reached_back[next] = ws->epoch;
+                stack[n++] = next;
+            }
+        }
+    }
+
+    while (ok && !is_empty(q)) {
+        City* c = pop(q).city;
+
+        if (c == c_pocz) {
+            ws->repair[c->city_id] = INT_MAX;
+            ws->previous_city[c->city_id] = NULL;
+            ws->only_one_path[c->city_id] = true;
+        }
+        else {
+            resolve_city(ws, g, c->city_id);
+        }
+    }
+
+    return ok;
+}
+
+void delta_stepping_path(search_workspace* ws, worker_pool* pool,
+                         graph_snapshot* g, City* c_pocz, City* c_kon,
+                         national_route* route) {
+    size_t n_of_workers = pool ? worker_count(pool) : 1;
+    delta_search s;
+
+    begin_search(ws);
+    exclude_route(ws, route);
+
+    s.ws = ws;
+    s.g = g;
+    s.c_kon = c_kon;
+    s.delta = g->mean_length;
+
+    s.found = (relaxations*)calloc(n_of_workers, sizeof(relaxations));
+    unsigned* frontier = (unsigned*)malloc((g->n_of_cities + 1) *
+                                           sizeof(unsigned));
+    unsigned* bucket = (unsigned*)malloc((g->n_of_cities + 1) *
+                                         sizeof(unsigned));
+    bool ok = s.found && frontier && bucket;
+
+    ws->reached[c_pocz->city_id] = ws->epoch;
+    ws->length[c_pocz->city_id] = 0;
+    ok = ok && add(ws->queue, make_path(c_pocz, 1, 0)) &&
+         find_lengths(&s, pool, frontier, bucket);
+
+    if (ok && ws->reached[c_kon->city_id] == ws->epoch)
+        ok = resolve_repairs(&s, c_pocz, frontier);
+
+    if (!ok) {
+        ws->reached[c_kon->city_id] = ws->epoch;
+        ws->previous_city[c_kon->city_id] = NULL;
+        ws->only_one_path[c_kon->city_id] = false;
+        ws->out_of_memory = true;
+    }
+
+    for (size_t w = 0; s.found && w < n_of_workers; w++)
+        free(s.found[w].items);
+    free(s.found);
+    free(frontier);
+    free(bucket);
+}
@@ -0,0 +1,42 @@
+/** @file
+ * Biblioteka definiująca wyszukiwanie optymalnej drogi algorytmem
+ * delta-stepping, dzielące pracę jednego wyszukiwania pomiędzy wątki.
+ */
+
+#ifndef DROGI_DELTA_STEPPING_H
+#define DROGI_DELTA_STEPPING_H
+
+#include "list.h"
+#include "specifications.h"
+#include "search_workspace.h"
+#include "graph_snapshot.h"
+#include "worker_pool.h"
+
+/** @brief Znajduje optymalną drogę pomiędzy dwoma miastami algorytmem
+ * delta-stepping.
+ *  Wyznacza w pamięci roboczej @p ws te same informacje o mieście końcowym
+ *  i miastach leżących na najlepszej drodze do niego co @ref shortest_path.
+ *  Najpierw wyznacza długości najkrótszych dróg, odwiedzając miasta
+ *  kubełkami długości drogi o szerokości średniej długości odcinka.
+ *  Odcinki wychodzące z miast kubełka są przeglądane równolegle przez wątki
+ *  puli, a znalezione krótsze drogi zapisuje wątek wywołujący, więc wynik
+ *  nie zależy od liczby wątków. Następnie dla miast, przez które prowadzą
+ *  najkrótsze drogi do miasta końcowego, wyznacza rok remontu najstarszego
+ *  odcinka i jednoznaczność najlepszej drogi.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in, out] pool    - Pula wątków lub NULL, gdy wyszukiwanie ma być
+ * wykonane w jednym wątku;
+ * @param [in] g            - Aktualna migawka grafu, zawierająca oba
+ * miasta;
+ * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
+ * miasto początkowe;
+ * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
+ * miasto końcowe;
+ * @param [in] route        - Droga, przez którą nie może przechodzić
+ * szukana droga.
+ */
+void delta_stepping_path(search_workspace* ws, worker_pool* pool,
+                         graph_snapshot* g, City* c_pocz, City* c_kon,
+                         national_route* route);
+
+#endif //DROGI_DELTA_STEPPING_H
@@ -8,115 +8,636 @@
 
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
-void shortest_path(City *c_pocz, City *c_kon, size_t n_of_cities,
-                   list *route, City **previous_city, bool *only_one_path) {
-    priority_queue* q = make_priority_queue(n_of_cities);
-    if (!q)
-        return;
+/** @brief Typ danych służący do przeglądania odcinków wychodzących z miasta.
+ * Odcinki są czytane z migawki grafu, jeżeli ją podano, albo z listy
+ * odcinków miasta.
+ */
+typedef struct road_cursor {
+    graph_snapshot* g; ///< Migawka grafu lub NULL
+    City* city; ///< Miasto, z którego wychodzą odcinki
+    size_t x; ///< Następny odcinek w migawce
+    size_t end; ///< Koniec odcinków miasta w migawce
+    road_list* rl; ///< Następny element listy odcinków
+} road_cursor;
 
-    bool* odw = (bool*)malloc(n_of_cities * sizeof(bool));
-    if (!odw) {
-        free_priority_queue(q);
-        return;
+/** @brief Ustawia kursor na pierwszym odcinku wychodzącym z miasta.
+ * Odcinki miasta, którego nie ma w migawce, są czytane z jego listy.
+ * @param [out] rc          - Kursor;
+ * @param [in] g            - Migawka grafu lub NULL;
+ * @param [in] city         - Miasto, którego odcinki są przeglądane.
+ * @return Zwraca liczbę odcinków wychodzących z @p city.
+ */
+static size_t open_roads(road_cursor* rc, graph_snapshot* g, City* city) {
+    rc->g = (g && city->city_id < g->n_of_cities) ? g : NULL;
+    rc->city = city;
+
+    if (rc->g) {
+        rc->x = g->offset[city->city_id];
+        rc->end = g->offset[city->city_id + 1];
+        rc->rl = NULL;
+        return rc->end - rc->x;
+    }
+
+    rc->x = rc->end = 0;
+    rc->rl = city->roads;
+    return city->n_of_roads;
+}
+
+/** @brief Przechodzi do następnego odcinka.
+ * @param [in, out] rc      - Kursor;
+ * @param [out] next_id     - Numer Id sąsiedniego miasta;
+ * @param [out] next        - Sąsiednie miasto;
+ * @param [out] length      - Długość odcinka drogi;
+ * @param [out] repairYear  - Rok budowy lub ostatniego remontu odcinka.
+ * @return Zwraca @p false jeżeli przejrzano już wszystkie odcinki,
+ * @p true w przeciwnym wypadku.
+ */
+static bool next_road(road_cursor* rc, size_t* next_id, City** next,
+                      unsigned* length, int* repairYear) {
+    if (rc->g) {
+        if (rc->x == rc->end)
+            return false;
+
+        *next_id = rc->g->neighbour[rc->x];
+        *next = rc->g->cities[*next_id];
+        *length = rc->g->length[rc->x];
+        *repairYear = rc->g->repair_year[rc->x];
+        rc->x++;
+        return true;
     }
 
-    for (size_t i = 0; i < n_of_cities; i++)
-        odw[i] = false;
+    if (!rc->rl)
+        return false;
+
+    Road* road = rc->rl->road;
+    *next = (road->city1 == rc->city) ? road->city2 : road->city1;
+    *next_id = (*next)->city_id;
+    *length = road->length;
+    *repairYear = road->repairYear;
+    rc->rl = rc->rl->next_road;
+    return true;
+}
+
+/** @brief Zapisuje najlepszą znaną drogę do miasta w pamięci roboczej.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą;
+ * @param [in] city         - Miasto, do którego prowadzi droga;
+ * @param [in] previous     - Miasto poprzedzające @p city na tej drodze;
+ * @param [in] length       - Długość tej drogi;
+ * @param [in] unique       - Czy ta droga jest jedyną najlepszą.
+ */
+static void reach(search_workspace* ws, City* city, City* previous,
+                  unsigned length, bool unique) {
+    ws->reached[city->city_id] = ws->epoch;
+    ws->previous_city[city->city_id] = previous;
+    ws->length[city->city_id] = length;
+    ws->only_one_path[city->city_id] = unique;
+}
+
+/** @brief Sprawdza, czy w bieżącym wyszukiwaniu znaleziono jedyną najlepszą
+ * drogę do miasta.
+ * @param [in] ws           - Wskaźnik na pamięć roboczą;
+ * @param [in] city         - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca @p true jeżeli do @p city prowadzi dokładnie jedna
+ * najlepsza droga, @p false w przeciwnym wypadku.
+ */
+static bool has_only_one_path(search_workspace* ws, City* city) {
+    return ws->reached[city->city_id] == ws->epoch &&
+           ws->only_one_path[city->city_id];
+}
+
+/** @brief Rozważa dojście do sąsiedniego miasta odcinkiem drogi.
+ * Jeżeli podano tablice odległości od miast orientacyjnych, to priorytet
+ * drogi w kolejce uwzględnia dolne ograniczenie długości reszty drogi do
+ * miasta końcowego, a miasta niepołączone z nim są pomijane.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą;
+ * @param [in] lm           - Tablice odległości lub NULL;
+ * @param [in] pp           - Najlepsza droga do miasta @p c;
+ * @param [in] c            - Odwiedzane miasto;
+ * @param [in] nextCity_id  - Numer Id sąsiedniego miasta;
+ * @param [in] nextCity     - Sąsiednie miasto;
+ * @param [in] length       - Długość odcinka drogi;
+ * @param [in] repairYear   - Rok budowy lub ostatniego remontu odcinka;
+ * @param [in] c_kon        - Miasto końcowe wyszukiwania.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool relax(search_workspace* ws, landmarks* lm, path_priority pp,
+                  City* c, size_t nextCity_id, City* nextCity,
+                  unsigned length, int repairYear, City* c_kon) {
+    /* Sprawdzamy najpierw tablice pamięci roboczej, żeby nie sięgać do
+     * struktury miasta, które i tak zostanie pominięte. */
+    if (ws->settled[nextCity_id] == ws->epoch ||
+        (ws->excluded[nextCity_id] == ws->epoch && nextCity != c_kon))
+        return true;
+
+    int repair = MIN(pp.last_repair, repairYear);
+    path_priority pom = make_path(nextCity, repair, pp.total_length + length);
+    path_priority pom2 = get_city_priority(ws->queue, nextCity);
+
+    if (lm) {
+        /* Ograniczenie liczymy tylko przy pierwszym dotarciu do miasta,
+         * potem odczytujemy je z drogi w kolejce. */
+        unsigned rest = (pom2.last_repair == 0) ?
+            landmark_bound(lm, nextCity, c_kon) :
+            pom2.bound - pom2.total_length;
+
+        if (rest == UINT_MAX)
+            return true;
+
+        /* Przy przepełnieniu ograniczenie pozostaje nie mniejsze od
+         * długości drogi. */
+        pom.bound = (rest < UINT_MAX - pom.total_length) ?
+                    pom.total_length + rest : UINT_MAX;
+    }
+
+    /* Gorsza droga nie może zmienić informacji o jednoznaczności
+     * najlepszej drogi do miasta. */
+    if (compare_priority(pom, pom2) == 0) {
+        ws->only_one_path[nextCity_id] = false;
+    }
+    else if (compare_priority(pom, pom2) > 0) {
+        reach(ws, nextCity, c, pom.total_length, true);
+        return add(ws->queue, pom);
+    }
+
+    return true;
+}
+
+/** @brief Znajduje optmalną drogę pomiędzy dwoma miastami algorytmem
+ * Dijkstry lub A*.
+ * Jeżeli podano drugie miasto początkowe, to wyszukiwanie zaczyna się
+ * jednocześnie od obu miast początkowych i znajduje optymalną drogę z
+ * któregokolwiek z nich. Miasta początkowe nie mają poprzedników.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in] lm           - Tablice odległości od miast orientacyjnych
+ * dla algorytmu A* lub NULL dla algorytmu Dijkstry;
+ * @param [in] g            - Aktualna migawka grafu lub NULL;
+ * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
+ * miasto początkowe;
+ * @param [in] c_pocz2      - Wskaźnik na drugie miasto początkowe lub NULL;
+ * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
+ * miasto końcowe;
+ * @param [in] route        - Droga, przez którą nie może przechodzić
+ * szukana droga.
+ */
+static void directed_path(search_workspace* ws, landmarks* lm,
+                          graph_snapshot* g, City *c_pocz, City *c_pocz2,
+                          City *c_kon, national_route* route) {
+    priority_queue* q = ws->queue;
+
+    begin_search(ws);
+    exclude_route(ws, route);
 
     path_priority pp = make_path(c_pocz, INT_MAX, 0);
-    add(q, pp);
+    reach(ws, c_pocz, NULL, 0, true);
+    bool memory_error = !add(q, pp);
+
+    if (c_pocz2) {
+        reach(ws, c_pocz2, NULL, 0, true);
+        memory_error = memory_error || !add(q, make_path(c_pocz2, INT_MAX, 0));
+    }
 
-    while (!is_empty(q) && pp.city != c_kon) {
+    while (!memory_error && !is_empty(q) && pp.city != c_kon) {
         pp = pop(q);
         City* c = pp.city;
-        road_list* rl = c->roads;
-        odw[c->city_id] = true;
-        while (rl) {
-            Road* road = rl->road;
-            City* nextCity = (road->city1 == c) ? road->city2 : road->city1;
-            size_t nextCity_id = nextCity->city_id;
-
-            if (!odw[nextCity_id] && (!exists(route, nextCity) || nextCity == c_kon)) {
-                int repair = MIN(pp.last_repair, road->repairYear);
-                path_priority pom = make_path(nextCity, repair, pp.total_length + road->length);
-                path_priority pom2 = get_city_priority(q, nextCity);
-
-                if (compare_priority(pom, pom2) == 0) {
-                    only_one_path[nextCity_id] = false;
+        ws->settled[c->city_id] = ws->epoch;
+
+        road_cursor rc;
+        ws->work += open_roads(&rc, g, c) + 1;
+
+        size_t nextCity_id;
+        City* nextCity;
+        unsigned length;
+        int repairYear;
+
+        while (next_road(&rc, &nextCity_id, &nextCity, &length, &repairYear)) {
+            if (!relax(ws, lm, pp, c, nextCity_id, nextCity, length,
+                       repairYear, c_kon)) {
+                memory_error = true;
+                break;
+            }
+        }
+    }
+
+    if (memory_error) {
+        reach(ws, c_kon, NULL, 0, false);
+        ws->out_of_memory = true;
+    }
+}
+
+void shortest_path(search_workspace* ws, graph_snapshot* g,
+                   City *c_pocz, City *c_kon, national_route* route) {
+    directed_path(ws, NULL, g, c_pocz, NULL, c_kon, route);
+}
+
+void landmark_path(search_workspace* ws, landmarks* lm, graph_snapshot* g,
+                   City *c_pocz, City *c_kon, national_route* route) {
+    directed_path(ws, lm, g, c_pocz, NULL, c_kon, route);
+}
+
+/** @brief Rozważa dojście do sąsiedniego miasta w wyszukiwaniu od miasta
+ * końcowego.
+ * To wyszukiwanie liczy tylko długości najkrótszych dróg.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą;
+ * @param [in] length       - Długość drogi z sąsiedniego miasta do miasta
+ * końcowego;
+ * @param [in] nextCity_id  - Numer Id sąsiedniego miasta;
+ * @param [in] nextCity     - Sąsiednie miasto;
+ * @param [in] c_pocz       - Miasto początkowe wyszukiwania.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool relax_back(search_workspace* ws, unsigned length,
+                       size_t nextCity_id, City* nextCity, City* c_pocz) {
+    if (ws->settled_back[nextCity_id] == ws->epoch ||
+        (ws->excluded[nextCity_id] == ws->epoch && nextCity != c_pocz))
+        return true;
+
+    if (ws->reached_back[nextCity_id] == ws->epoch &&
+        ws->length_back[nextCity_id] <= length)
+        return true;
+
+    ws->reached_back[nextCity_id] = ws->epoch;
+    ws->length_back[nextCity_id] = length;
+    return add(ws->queue_back, make_path(nextCity, INT_MAX, length));
+}
+
+/** @brief Sprawdza, czy miasto leży na którejś z najkrótszych dróg.
+ * @param [in] ws           - Wskaźnik na pamięć roboczą;
+ * @param [in] city_id      - Numer Id miasta;
+ * @param [in] length       - Długość najkrótszej drogi z miasta początkowego
+ * do miasta @p city_id;
+ * @param [in] distance     - Długość najkrótszej drogi między miastem
+ * początkowym a końcowym.
+ * @return Zwraca @p true jeżeli miasto zostało odwiedzone w wyszukiwaniu od
+ * miasta końcowego i leży na najkrótszej drodze, @p false w przeciwnym
+ * wypadku.
+ */
+static bool on_shortest_path(search_workspace* ws, size_t city_id,
+                             unsigned length, unsigned distance) {
+    return ws->settled_back[city_id] == ws->epoch &&
+           length + ws->length_back[city_id] == distance;
+}
+
+void bidirectional_path(search_workspace* ws, graph_snapshot* g,
+                        City *c_pocz, City *c_kon, national_route* route) {
+    priority_queue* q = ws->queue;
+    priority_queue* qb = ws->queue_back;
+
+    begin_search(ws);
+    exclude_route(ws, route);
+
+    /* Jednokierunkowe wyszukiwanie nie dociera wtedy do żadnego miasta. */
+    if (c_pocz == c_kon)
+        return;
+
+    reach(ws, c_pocz, NULL, 0, true);
+    ws->reached_back[c_kon->city_id] = ws->epoch;
+    ws->length_back[c_kon->city_id] = 0;
+
+    bool memory_error = !add(q, make_path(c_pocz, INT_MAX, 0)) ||
+                        !add(qb, make_path(c_kon, INT_MAX, 0));
+    /* Długość najkrótszej znanej drogi złożonej z dróg znalezionych
+     * w obu wyszukiwaniach. */
+    unsigned distance = UINT_MAX;
+
+    road_cursor rc;
+    size_t nextCity_id;
+    City* nextCity;
+    unsigned length;
+    int repairYear;
+
+    /* Najpierw oba wyszukiwania liczą długość najkrótszej drogi. Gdy suma
+     * długości na szczytach kolejek przekroczy najkrótszą znaną drogę, każde
+     * miasto najkrótszej drogi zostało już odwiedzone przez któreś
+     * z wyszukiwań. */
+    while (!memory_error && !is_empty(q) && !is_empty(qb)) {
+        unsigned long long bound = (unsigned long long)top(q).total_length +
+                                   top(qb).total_length;
+        if (bound > distance)
+            break;
+
+        if (top(q).total_length <= top(qb).total_length) {
+            path_priority pp = pop(q);
+            City* c = pp.city;
+            ws->settled[c->city_id] = ws->epoch;
+
+            /* Tak jak w jednokierunkowym wyszukiwaniu kończymy, gdy
+             * odwiedzimy miasto końcowe. */
+            if (c == c_kon)
+                return;
+
+            ws->work += open_roads(&rc, g, c) + 1;
+
+            while (next_road(&rc, &nextCity_id, &nextCity, &length,
+                             &repairYear)) {
+                if (!relax(ws, NULL, pp, c, nextCity_id, nextCity, length,
+                           repairYear, c_kon)) {
+                    memory_error = true;
+                    break;
                 }
-                else {
-                    only_one_path[nextCity_id] = true;
 
-                    if (compare_priority(pom, pom2) > 0)
-                        previous_city[nextCity_id] = c;
+                if (ws->reached_back[nextCity_id] == ws->epoch)
+                    distance = MIN(distance, pp.total_length + length +
+                                             ws->length_back[nextCity_id]);
+            }
+        }
+        else {
+            path_priority pp = pop(qb);
+            City* c = pp.city;
+            ws->settled_back[c->city_id] = ws->epoch;
+
+            if (c == c_pocz)
+                break;
+
+            ws->work += open_roads(&rc, g, c) + 1;
+
+            while (next_road(&rc, &nextCity_id, &nextCity, &length,
+                             &repairYear)) {
+                if (!relax_back(ws, pp.total_length + length, nextCity_id,
+                                nextCity, c_pocz)) {
+                    memory_error = true;
+                    break;
                 }
 
-                add(q, pom);
+                if (ws->reached[nextCity_id] == ws->epoch)
+                    distance = MIN(distance, pp.total_length + length +
+                                             ws->length[nextCity_id]);
             }
+        }
+    }
 
-            rl = rl->next_road;
+    /* Potem wyszukiwanie od miasta początkowego dokańcza etykiety miast
+     * leżących na najkrótszych drogach, pomijając pozostałe miasta. Każdy
+     * poprzednik miasta na najkrótszej drodze również na niej leży, więc
+     * etykiety i informacje o jednoznaczności są takie same jak
+     * w jednokierunkowym wyszukiwaniu. */
+    while (!memory_error && distance != UINT_MAX && !is_empty(q)) {
+        path_priority pp = pop(q);
+        City* c = pp.city;
+        ws->settled[c->city_id] = ws->epoch;
+
+        if (c == c_kon)
+            return;
+
+        if (!on_shortest_path(ws, c->city_id, pp.total_length, distance))
+            continue;
+
+        ws->work += open_roads(&rc, g, c) + 1;
+
+        while (next_road(&rc, &nextCity_id, &nextCity, &length, &repairYear)) {
+            if (!on_shortest_path(ws, nextCity_id, pp.total_length + length,
+                                  distance))
+                continue;
+
+            if (!relax(ws, NULL, pp, c, nextCity_id, nextCity, length,
+                       repairYear, c_kon)) {
+                memory_error = true;
+                break;
+            }
         }
     }
-    free(odw);
-    free_priority_queue(q);
+
+    if (memory_error) {
+        reach(ws, c_kon, NULL, 0, false);
+        ws->out_of_memory = true;
+    }
 }
 
-bool find_path(list* l, list* route, City* c1, City* c2,
-               size_t n_of_cities) {
-    bool* only_one_path = (bool*)malloc(n_of_cities * sizeof(bool));
-    if (!only_one_path)
-        return false;
+/** @brief Znajduje optymalną drogę pomiędzy dwoma miastami za pomocą
+ * hierarchii skrótów.
+ *  Hierarchia wyznacza wszystkie odcinki leżące na najkrótszych drogach,
+ *  posortowane według odległości od miasta początkowego. Przeglądając je
+ *  w tej kolejności, wyznaczamy te same etykiety i informacje
+ *  o jednoznaczności co @ref shortest_path, bo każdy poprzednik miasta na
+ *  najkrótszej drodze również na niej leży.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in, out] ch      - Aktualna hierarchia skrótów;
+ * @param [in] g            - Aktualna migawka grafu lub NULL;
+ * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
+ * miasto początkowe;
+ * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
+ * miasto końcowe.
+ */
+static void hierarchy_path(search_workspace* ws, contraction_hierarchy* ch,
+                           graph_snapshot* g, City *c_pocz, City *c_kon) {
+    if (c_pocz == c_kon || !hierarchy_shortest_roads(ch, c_pocz, c_kon)) {
+        bidirectional_path(ws, g, c_pocz, c_kon, NULL);
+        return;
+    }
 
-    City** previous_city = (City**)malloc(n_of_cities * sizeof(City*));
-    if (!previous_city) {
-        free(only_one_path);
-        return false;
+    begin_search(ws);
+    reach(ws, c_pocz, NULL, 0, true);
+    ws->repair[c_pocz->city_id] = INT_MAX;
+
+    for (size_t i = 0; i < ch->n_of_roads; i++) {
+        shortest_road* r = &ch->roads[i];
+        size_t from = r->from->city_id, to = r->to->city_id;
+        path_priority pp = make_path(r->to, MIN(ws->repair[from],
+                                                r->road->repairYear),
+                                     r->distance);
+
+        if (ws->reached[to] != ws->epoch) {
+            reach(ws, r->to, r->from, r->distance, true);
+            ws->repair[to] = pp.last_repair;
+            continue;
+        }
+
+        int cmp = compare_priority(pp, make_path(r->to, ws->repair[to],
+                                                 ws->length[to]));
+        if (cmp == 0) {
+            ws->only_one_path[to] = false;
+        }
+        else if (cmp > 0) {
+            reach(ws, r->to, r->from, r->distance, true);
+            ws->repair[to] = pp.last_repair;
+        }
     }
 
+    ws->work += ch->n_of_roads + 1;
+}
 
-    for (size_t i = 0; i < n_of_cities; i++) {
-        only_one_path[i] = false;
-        previous_city[i] = NULL;
+bool find_path(search_workspace* ws, graph_snapshot* g,
+               contraction_hierarchy* ch, landmarks* lm, list* l,
+               national_route* route, City* c1, City* c2, size_t n_of_cities) {
+    if (!reserve_search_workspace(ws, n_of_cities)) {
+        ws->out_of_memory = true;
+        return false;
     }
 
-    shortest_path(c1, c2, n_of_cities, route, previous_city, only_one_path);
+    if (ws->mode == SEARCH_CONTRACTION && ch && !route)
+        hierarchy_path(ws, ch, g, c1, c2);
+    else if (ws->mode == SEARCH_PARALLEL && ws->workers && g &&
+             c1->city_id < g->n_of_cities && c2->city_id < g->n_of_cities)
+        delta_stepping_path(ws, ws->workers, g, c1, c2, route);
+    else if (ws->mode == SEARCH_LANDMARKS && lm)
+        landmark_path(ws, lm, g, c1, c2, route);
+    else if (ws->mode == SEARCH_DIJKSTRA)
+        shortest_path(ws, g, c1, c2, route);
+    else
+        bidirectional_path(ws, g, c1, c2, route);
     City* c = c2;
 
-    if (!only_one_path[c->city_id]) {
-        free(only_one_path);
-        free(previous_city);
+    if (!has_only_one_path(ws, c))
         return false;
-    }
 
     while (c != c1) {
-        if (!only_one_path[c->city_id]) {
-            free(only_one_path);
-            free(previous_city);
+        if (!has_only_one_path(ws, c))
             return false;
-        }
 
-        c = previous_city[c->city_id];
+        c = ws->previous_city[c->city_id];
     }
 
-    c = previous_city[c2->city_id];
+    for (c = c2; c != c1; ) {
+        c = ws->previous_city[c->city_id];
 
-    while (c != c1) {
         if (!add_to_beginning(l, c)) {
-            free_list(l);
-            l = NULL;
-            break;
+            ws->out_of_memory = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+list* find_extension(search_workspace* ws, graph_snapshot* g, landmarks* lm,
+                     national_route* route, City* city, size_t n_of_cities) {
+    if (route_contains(route, city))
+        return NULL;
+
+    if (!reserve_search_workspace(ws, n_of_cities)) {
+        ws->out_of_memory = true;
+        return NULL;
+    }
+
+    directed_path(ws, ws->mode == SEARCH_LANDMARKS ? lm : NULL, g,
+                  route_last_city(route), route_first_city(route), city,
+                  route);
+
+    City* c = city;
+    if (!has_only_one_path(ws, c))
+        return NULL;
+
+    while (ws->previous_city[c->city_id]) {
+        c = ws->previous_city[c->city_id];
+
+        if (!has_only_one_path(ws, c))
+            return NULL;
+    }
+
+    list* l = new_list(city);
+    list* end = l;
+    bool at_end = (c == route_last_city(route));
+
+    /* Fragment dołączany na końcu drogi zaczyna się w jej ostatnim mieście,
+     * a dołączany na początku kończy się w pierwszym, więc miasta z łańcucha
+     * poprzedników dopisujemy odpowiednio na początek lub na koniec. */
+    for (c = city; l && ws->previous_city[c->city_id]; ) {
+        c = ws->previous_city[c->city_id];
+
+        if (at_end) {
+            if (!add_to_beginning(l, c)) {
+                free_list(l);
+                l = NULL;
+            }
+            else {
+                l = l->prev;
+            }
+        }
+        else {
+            list* next = new_list(c);
+            if (!next) {
+                free_list(l);
+                l = NULL;
+            }
+            else {
+                add_list(end, next);
+                end = next;
+            }
         }
+    }
+
+    if (!l)
+        ws->out_of_memory = true;
+
+    return first_elem(l);
+}
+
+bool search_targets(search_workspace* ws, graph_snapshot* g, City* source,
+                    City** targets, size_t n_of_targets, size_t n_of_cities,
+                    route_info* result) {
+    if (!reserve_search_workspace(ws, n_of_cities)) {
+        ws->out_of_memory = true;
+        return false;
+    }
+
+    priority_queue* q = ws->queue;
+    begin_search(ws);
 
-        c = previous_city[c->city_id];
+    /* Miasta docelowe, których jeszcze nie odwiedzono, oznaczamy w tablicy
+     * nieużywanej przez wyszukiwanie w jedną stronę. */
+    size_t remaining = 0;
+    for (size_t i = 0; i < n_of_targets; i++) {
+        size_t id = targets[i]->city_id;
+
+        if (targets[i] != source && ws->reached_back[id] != ws->epoch) {
+            ws->reached_back[id] = ws->epoch;
+            remaining++;
+        }
     }
 
-    if (l) {
-        if (!add_to_beginning(l, c1)) {
-            free_list(l);
-            l = NULL;
+    reach(ws, source, NULL, 0, true);
+    bool memory_error = !add(q, make_path(source, INT_MAX, 0));
+
+    while (!memory_error && remaining > 0 && !is_empty(q)) {
+        path_priority pp = pop(q);
+        City* c = pp.city;
+        size_t id = c->city_id;
+        City* previous = ws->previous_city[id];
+
+        /* Odwiedzonego miasta nic już nie zmieni, więc zapisujemy w nim, czy
+         * cała droga do niego jest jedyna. */
+        ws->settled[id] = ws->epoch;
+        ws->repair[id] = pp.last_repair;
+        if (previous)
+            ws->only_one_path[id] = ws->only_one_path[id] &&
+                                    ws->only_one_path[previous->city_id];
+
+        if (ws->reached_back[id] == ws->epoch) {
+            ws->reached_back[id] = 0;
+            remaining--;
+        }
+
+        road_cursor rc;
+        ws->work += open_roads(&rc, g, c) + 1;
+
+        size_t nextCity_id;
+        City* nextCity;
+        unsigned length;
+        int repairYear;
+        while (next_road(&rc, &nextCity_id, &nextCity, &length, &repairYear)) {
+            if (!relax(ws, NULL, pp, c, nextCity_id, nextCity, length,
+                       repairYear, NULL)) {
+                memory_error = true;
+                break;
+            }
         }
     }
-    free(only_one_path);
-    free(previous_city);
+
+    if (memory_error) {
+        ws->out_of_memory = true;
+        return false;
+    }
+
+    for (size_t i = 0; i < n_of_targets; i++) {
+        size_t id = targets[i]->city_id;
+        route_info* r = &result[i];
+
+        r->exists = targets[i] != source && ws->settled[id] == ws->epoch;
+        r->unique = r->exists && ws->only_one_path[id];
+        r->length = r->exists ? ws->length[id] : 0;
+        r->oldest_repair = r->exists ? ws->repair[id] : 0;
+    }
+
     return true;
-}
\ No newline at end of file
+}
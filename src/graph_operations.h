@@ -9,36 +9,101 @@
 #include "hash.h"
 #include "specifications.h"
 #include "priority_queue.h"
+#include "search_workspace.h"
+#include "graph_snapshot.h"
+#include "contraction_hierarchy.h"
+#include "landmarks.h"
+#include "delta_stepping.h"
+
+/** @brief Typ danych opisujący najlepszą drogę pomiędzy dwoma miastami.
+ */
+typedef struct route_info {
+    bool exists; ///< Czy miasta są różne i łączy je jakaś droga
+    bool unique; ///< Czy najlepsza droga jest jedyna
+    unsigned length; ///< Długość najlepszej drogi lub 0
+    int oldest_repair; ///< Rok budowy lub ostatniego remontu najstarszego
+    ///< odcinka najlepszej drogi lub 0
+} route_info;
+
 /** @brief Znajduje optmalną drogę pomiędzy dwoma miastami.
  *  Znajduje optymalną drogę pomiędzi miastami @p c_pocz i @p c_kon.
  *  Optymalna droga nie może przechodzić przez miasta zawarte w @p route.
- *  Wyznacza w @p previous_cities dla każdego miasta miasto poprzedzajace je w
- *  najlepszej drodze do niego z miasta początkowego. Dla każdego miasta
- *  @p only_one_path trzyma informację czy do danego miasta istnieje tylko
- *  jedna optymalna droga z miasta początkowego. Jeżeli nie uda się zaalokować
- *  pamięci, to wszysktie dane pozostaną bez zmian.
+ *  Wyznacza w pamięci roboczej @p ws dla każdego osiągniętego miasta miasto
+ *  poprzedzajace je w najlepszej drodze do niego z miasta początkowego oraz
+ *  informację czy do danego miasta istnieje tylko jedna optymalna droga
+ *  z miasta początkowego. Jeżeli nie uda się zaalokować pamięci, to droga do
+ *  @p c_kon zostaje oznaczona jako niejednoznaczna. Jeżeli podano migawkę
+ *  grafu @p g, to odcinki dróg są czytane z niej zamiast z list odcinków.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in] g            - Aktualna migawka grafu lub NULL;
  * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
  * miasto początkowe;
  * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
  * miasto końcowe;
- * @param [in] n_of_cities  - Maksymalna liczba miast;
  * @param [in] route        - Droga, przez którą nie może przechodzić
- * szukana droga;
- * @param [in, out] previous_city- Tablica wypełniona @p NULL,
- * która będzie wypełniona w trakcie działania funkcji;
- * @param [in, out] only_one_path- Tablica zawierająca tylko wartości @p false,
- * która będzie wypełniona w trakcie działania funkcji
+ * szukana droga.
  */
-void shortest_path(City *c_pocz, City *c_kon, size_t n_of_cities,
-                   list *route, City **previous_city, bool *only_one_path);
+void shortest_path(search_workspace* ws, graph_snapshot* g,
+                   City *c_pocz, City *c_kon, national_route* route);
+
+/** @brief Znajduje optmalną drogę pomiędzy dwoma miastami algorytmem A*.
+ *  Wyznacza w pamięci roboczej @p ws te same informacje o mieście końcowym
+ *  i miastach leżących na najlepszej drodze do niego co @ref shortest_path.
+ *  Miasta są odwiedzane w kolejności sumy długości drogi do nich i dolnego
+ *  ograniczenia z nierówności trójkąta dla miast orientacyjnych, a przy
+ *  równych sumach w kolejności długości drogi. Dzięki temu każdy poprzednik
+ *  miasta na najkrótszej drodze jest odwiedzony przed nim.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in] lm           - Aktualne tablice odległości od miast
+ * orientacyjnych;
+ * @param [in] g            - Aktualna migawka grafu lub NULL;
+ * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
+ * miasto początkowe;
+ * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
+ * miasto końcowe;
+ * @param [in] route        - Droga, przez którą nie może przechodzić
+ * szukana droga.
+ */
+void landmark_path(search_workspace* ws, landmarks* lm, graph_snapshot* g,
+                   City *c_pocz, City *c_kon, national_route* route);
+
+/** @brief Znajduje optmalną drogę pomiędzy dwoma miastami, szukając
+ * jednocześnie od obu jej końców.
+ *  Wyznacza w pamięci roboczej @p ws te same informacje o mieście końcowym
+ *  i miastach leżących na najlepszej drodze do niego co @ref shortest_path.
+ *  Wyszukiwania od obu końców wyznaczają najpierw długość najkrótszej drogi,
+ *  a następnie wyszukiwanie od miasta początkowego odwiedza już tylko
+ *  miasta leżące na najkrótszych drogach.
+ * @param [in, out] ws      - Pamięć robocza mieszcząca wszystkie miasta;
+ * @param [in] g            - Aktualna migawka grafu lub NULL;
+ * @param [in] c_pocz       - Wskaźnik na strukturę reprezentującą
+ * miasto początkowe;
+ * @param [in] c_kon        - Wskaźnik na strukturę reprezentującą
+ * miasto końcowe;
+ * @param [in] route        - Droga, przez którą nie może przechodzić
+ * szukana droga.
+ */
+void bidirectional_path(search_workspace* ws, graph_snapshot* g,
+                        City *c_pocz, City *c_kon, national_route* route);
 
 /** @brief Znajduje optymalną drogę pomiędzy dwoma miastami.
  * Znajduje optymalną drogę pomiędzy @p city1 i @p city2 nieprzechodzącą
  * przez żadne miasto z @p route. Zapisuję tą drogę jako ciąg miast do
- * @p l.
+ * @p l. Sposób wyszukiwania wybiera pole @p mode pamięci roboczej.
+ * Hierarchia skrótów nie uwzględnia wykluczonych miast, więc w trybie
+ * @ref SEARCH_CONTRACTION jest używana tylko wtedy, gdy @p route jest NULL,
+ * a w pozostałych przypadkach droga jest szukana od obu końców. W trybie
+ * @ref SEARCH_PARALLEL wyszukiwanie jest dzielone pomiędzy wątki, gdy
+ * pamięć robocza wskazuje pulę wątków i podano migawkę grafu zawierającą
+ * oba miasta, a w przeciwnym wypadku droga też jest szukana od obu końców.
+ * @param [in, out] ws            - Pamięć robocza wyszukiwania;
+ * @param [in] g                  - Aktualna migawka grafu lub NULL;
+ * @param [in, out] ch            - Aktualna hierarchia skrótów lub NULL;
+ * @param [in] lm                 - Aktualne tablice odległości od miast
+ * orientacyjnych lub NULL, używane w trybie @ref SEARCH_LANDMARKS;
  * @param [in, out] l             - Wskaźnik na listę dwukierunkową zawierającą
  * miasto początkowe;
- * @param [in] route         - Droga przedstawiona jako ciąg miast;
+ * @param [in] route         - Droga krajowa lub NULL;
  * @param [in] city1         - Wskaźnik na strukturę reprezentującą
  * miasto początkowe;
  * @param [in] city2         - Wskaźnik na strukturę reprezentującą
@@ -46,8 +111,54 @@ void shortest_path(City *c_pocz, City *c_kon, size_t n_of_cities,
  * @param [in] n_of_cities   - Maksymalna ilość miast.
  * @return Zwraca @p true jeżeli usało się jednoznacznie znaleźć optymalną drogę.
  * Zwraca false w przeciwnym wypadku lub gdy nie uda się zaalokować pamięci.
+ * Brak pamięci jest zaznaczany w polu @p out_of_memory pamięci roboczej.
  */
-bool find_path(list* l, list* route, City* city1, City* city2,
+bool find_path(search_workspace* ws, graph_snapshot* g,
+               contraction_hierarchy* ch, landmarks* lm, list* l,
+               national_route* route, City* city1, City* city2,
                size_t n_of_cities);
 
+/** @brief Znajduje optymalny fragment wydłużający drogę do miasta.
+ * Szuka jednocześnie od obu końców drogi @p route, więc jedno wyszukiwanie
+ * wybiera lepsze z wydłużeń na końcu i na początku drogi, a równie dobre
+ * wydłużenia z obu końców dają niejednoznaczny wynik. Nowy fragment nie
+ * może przechodzić przez miasta drogi. W trybie @ref SEARCH_LANDMARKS
+ * używa algorytmu A*, a w pozostałych algorytmu Dijkstry.
+ * @param [in, out] ws            - Pamięć robocza wyszukiwania;
+ * @param [in] g                  - Aktualna migawka grafu lub NULL;
+ * @param [in] lm                 - Aktualne tablice odległości od miast
+ * orientacyjnych lub NULL;
+ * @param [in] route              - Droga krajowa;
+ * @param [in] city               - Wskaźnik na miasto, do którego
+ * wydłużana jest droga;
+ * @param [in] n_of_cities        - Maksymalna ilość miast.
+ * @return Zwraca pierwszy element listy miast nowego fragmentu: od
+ * ostatniego miasta drogi do @p city albo od @p city do pierwszego miasta
+ * drogi. Zwraca NULL, jeżeli @p city leży na drodze, nie można
+ * jednoznacznie wyznaczyć fragmentu lub nie udało się zaalokować pamięci.
+ * Brak pamięci jest zaznaczany w polu @p out_of_memory pamięci roboczej.
+ */
+list* find_extension(search_workspace* ws, graph_snapshot* g, landmarks* lm,
+                     national_route* route, City* city, size_t n_of_cities);
+
+/** @brief Opisuje najlepsze drogi z jednego miasta do wielu miast.
+ * Przeszukuje graf algorytmem Dijkstry z miasta @p source, dopóki nie
+ * odwiedzi wszystkich miast docelowych. Drogi są porównywane tak jak przy
+ * tworzeniu drogi krajowej, a droga jest jedyna, gdy jedyna jest najlepsza
+ * droga do każdego miasta na niej.
+ * @param [in, out] ws            - Pamięć robocza wyszukiwania;
+ * @param [in] g                  - Aktualna migawka grafu lub NULL;
+ * @param [in] source             - Wskaźnik na miasto początkowe;
+ * @param [in] targets            - Tablica miast docelowych;
+ * @param [in] n_of_targets       - Liczba miast docelowych;
+ * @param [in] n_of_cities        - Maksymalna ilość miast;
+ * @param [out] result            - Tablica opisów dróg do kolejnych miast
+ * docelowych.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, @p true
+ * w przeciwnym wypadku.
+ */
+bool search_targets(search_workspace* ws, graph_snapshot* g, City* source,
+                    City** targets, size_t n_of_targets, size_t n_of_cities,
+                    route_info* result);
+
 #endif //DROGI_GRAPH_H
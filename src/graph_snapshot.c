@@ -0,0 +1,79 @@
+#include "graph_snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+void free_graph_snapshot(graph_snapshot* g) {
+    if (!g)
+        return;
+
+    free(g->offset);
+    free(g->neighbour);
+    free(g->length);
+    free(g->repair_year);
+    free(g->cities);
+    free(g);
+}
+
+graph_snapshot* build_graph_snapshot(City** cities, size_t n_of_cities,
+                                     size_t n_of_roads) {
+    graph_snapshot* g = (graph_snapshot*)malloc(sizeof(graph_snapshot));
+    if (!g)
+        return NULL;
+
+    size_t n_of_entries = 2 * n_of_roads + 1;
+    g->n_of_cities = n_of_cities;
+    g->offset = (size_t*)malloc((n_of_cities + 1) * sizeof(size_t));
+    g->neighbour = (unsigned*)malloc(n_of_entries * sizeof(unsigned));
+    g->length = (unsigned*)malloc(n_of_entries * sizeof(unsigned));
+    g->repair_year = (int*)malloc(n_of_entries * sizeof(int));
+    g->cities = (City**)malloc((n_of_cities + 1) * sizeof(City*));
+
+    if (!g->offset || !g->neighbour || !g->length || !g->repair_year ||
+        !g->cities) {
+        free_graph_snapshot(g);
+        return NULL;
+    }
+
+    memcpy(g->cities, cities, n_of_cities * sizeof(City*));
+
+    unsigned long long total_length = 0;
+    size_t x = 0;
+    for (size_t i = 0; i < n_of_cities; i++) {
+        City* c = cities[i];
+        g->offset[i] = x;
+
+        for (road_list* rl = c->roads; rl; rl = rl->next_road) {
+            Road* road = rl->road;
+            City* next = (road->city1 == c) ? road->city2 : road->city1;
+
+            g->neighbour[x] = next->city_id;
+            g->length[x] = road->length;
+            g->repair_year[x] = road->repairYear;
+            total_length += road->length;
+            x++;
+        }
+    }
+    g->offset[n_of_cities] = x;
+    g->mean_length = x ? (unsigned)((total_length + x - 1) / x) : 1;
+
+    return g;
+}
+
+/* Zmienia rok remontu w wierszu miasta @p c1 przy sąsiedzie @p c2. */
+static void repair_entry(graph_snapshot* g, City* c1, City* c2,
+                         int repairYear) {
+    size_t end = g->offset[c1->city_id + 1];
+
+    for (size_t x = g->offset[c1->city_id]; x < end; x++) {
+        if (g->neighbour[x] == c2->city_id) {
+            g->repair_year[x] = repairYear;
+            return;
+        }
+    }
+}
+
+void snapshot_repair_road(graph_snapshot* g, City* city1, City* city2,
+                          int repairYear) {
+    repair_entry(g, city1, city2, repairYear);
+    repair_entry(g, city2, city1, repairYear);
+}
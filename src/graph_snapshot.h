@@ -0,0 +1,53 @@
+/** @file
+ * Biblioteka definiująca zwartą migawkę grafu dróg (w formacie CSR),
+ * używaną przez wyszukiwanie dróg, gdy graf długo się nie zmienia.
+ */
+
+#ifndef DROGI_GRAPH_SNAPSHOT_H
+#define DROGI_GRAPH_SNAPSHOT_H
+
+#include <stddef.h>
+#include "specifications.h"
+
+/** @brief Typ danych przechowujący migawkę grafu dróg.
+ * Odcinki wychodzące z miasta o numerze Id @p i zajmują miejsca od
+ * @p offset[i] do @p offset[i + 1] - 1 w tablicach @p neighbour, @p length
+ * i @p repair_year, w tej samej kolejności co na liście odcinków miasta.
+ */
+typedef struct graph_snapshot {
+    size_t n_of_cities; ///< Liczba miast
+    size_t* offset; ///< Początki list sąsiadów kolejnych miast
+    unsigned* neighbour; ///< Numery Id sąsiednich miast
+    unsigned* length; ///< Długości odcinków drogi
+    int* repair_year; ///< Lata budowy lub ostatniego remontu odcinków
+    City** cities; ///< Miasta w kolejności numerów Id
+    unsigned mean_length; ///< Średnia długość odcinka drogi zaokrąglona
+    ///< w górę lub 1, jeżeli nie ma odcinków
+} graph_snapshot;
+
+/** @brief Tworzy migawkę grafu.
+ * @param [in] cities       - Tablica miast w kolejności numerów Id;
+ * @param [in] n_of_cities  - Liczba miast;
+ * @param [in] n_of_roads   - Liczba odcinków drogi.
+ * @return Zwraca wskaźnik na migawkę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+graph_snapshot* build_graph_snapshot(City** cities, size_t n_of_cities,
+                                     size_t n_of_roads);
+
+/** @brief Usuwa migawkę grafu.
+ * Nic nie robi, jeżeli @p g ma wartość NULL.
+ * @param [in, out] g       - Wskaźnik na migawkę grafu.
+ */
+void free_graph_snapshot(graph_snapshot* g);
+
+/** @brief Zmienia w migawce rok ostatniego remontu odcinka drogi.
+ * @param [in, out] g       - Wskaźnik na migawkę grafu;
+ * @param [in] city1        - Wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] city2        - Wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] repairYear   - Rok remontu odcinka drogi.
+ */
+void snapshot_repair_road(graph_snapshot* g, City* city1, City* city2,
+                          int repairYear);
+
+#endif //DROGI_GRAPH_SNAPSHOT_H
@@ -5,96 +5,306 @@
 #include "hash.h"
 #include "specifications.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define INITIAL_CAPACITY 64
+/* Liczba miejsc starej tablicy przenoszonych przy każdym wstawieniu. Przy
+ * dwukrotnym powiększeniu przeniesienie kończy się, zanim nowa tablica
+ * zapełni się w 7/8. */
+#define MIGRATION_STEP (2 * GROUP_SIZE)
+
+static unsigned char ctrl_of(size_t hash) {
+    return hash & 0x7F;
+}
+
+static size_t first_group(const city_table* t, size_t hash) {
+    return (hash >> 7) & (t->capacity / GROUP_SIZE - 1);
+}
+
+/* Zwraca maskę bitową miejsc grupy, których bajt kontrolny jest równy @p c. */
+static unsigned match_byte(const unsigned char* group, unsigned char c) {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < GROUP_SIZE; i++) {
+        if (group[i] == c)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/* Zwraca numer najmłodszego ustawionego bitu niezerowej maski. */
+static unsigned lowest_bit(unsigned m) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(m);
+#else
+    unsigned i = 0;
+    while (!(m & 1u)) {
+        m >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static bool init_table(city_table* t, size_t capacity) {
+    t->capacity = capacity;
+    t->size = 0;
+    t->ctrl = (unsigned char*)malloc(capacity);
+    t->slots = (City**)malloc(capacity * sizeof(City*));
+
+    if (!t->ctrl || !t->slots) {
+        free(t->ctrl);
+        free(t->slots);
+        t->capacity = 0;
+        t->ctrl = NULL;
+        t->slots = NULL;
+        return false;
+    }
+
+    memset(t->ctrl, CTRL_EMPTY, capacity);
+    return true;
+}
+
+static void free_table(city_table* t) {
+    free(t->ctrl);
+    free(t->slots);
+    t->capacity = 0;
+    t->size = 0;
+    t->ctrl = NULL;
+    t->slots = NULL;
+}
+
+static City* table_find(const city_table* t, size_t hash, const char* s,
+                        size_t length) {
+    if (t->capacity == 0)
+        return NULL;
+
+    size_t n_of_groups = t->capacity / GROUP_SIZE;
+    size_t g = first_group(t, hash);
+
+    for (size_t i = 0; i < n_of_groups; i++) {
+        const unsigned char* group = t->ctrl + g * GROUP_SIZE;
+        unsigned m = match_byte(group, ctrl_of(hash));
+
+        /* Pełny hasz i długość odrzucają prawie wszystkie kolizje bajtu
+         * kontrolnego bez porównywania napisów. */
+        while (m) {
+            City* c = t->slots[g * GROUP_SIZE + lowest_bit(m)];
+
+            if (c->name_hash == hash && c->name_length == length &&
+                memcmp(c->city_name, s, length) == 0)
+                return c;
+
+            m &= m - 1;
+        }
+
+        if (match_byte(group, CTRL_EMPTY))
+            return NULL;
+
+        g = (g + i + 1) & (n_of_groups - 1);
+    }
+
+    return NULL;
+}
+
+static void table_insert(city_table* t, size_t hash, City* city) {
+    size_t n_of_groups = t->capacity / GROUP_SIZE;
+    size_t g = first_group(t, hash);
+
+    for (size_t i = 0; ; i++) {
+        unsigned m = match_byte(t->ctrl + g * GROUP_SIZE, CTRL_EMPTY);
+
+        if (m) {
+            size_t x = g * GROUP_SIZE + lowest_bit(m);
+            t->ctrl[x] = ctrl_of(hash);
+            t->slots[x] = city;
+            t->size++;
+            return;
+        }
+
+        g = (g + i + 1) & (n_of_groups - 1);
+    }
+}
+
+/* Przenosi do @p current co najwyżej @p n_of_slots kolejnych miejsc tablicy
+ * @p previous. Przeniesione miejsca oznacza jako zwolnione, żeby nie
+ * przerywać ciągów sondowania w starej tablicy. */
+static void migrate(hashtable* tab, size_t n_of_slots) {
+    city_table* old = &tab->previous;
+
+    for (; n_of_slots > 0 && tab->migrated < old->capacity; n_of_slots--) {
+        size_t x = tab->migrated++;
+
+        if (!(old->ctrl[x] & CTRL_EMPTY)) {
+            table_insert(&tab->current, old->slots[x]->name_hash,
+                         old->slots[x]);
+            old->ctrl[x] = CTRL_DELETED;
+            old->size--;
+        }
+    }
+
+    if (old->capacity && tab->migrated == old->capacity)
+        free_table(old);
+}
+
 hashtable* new_hashtable() {
     hashtable* tab = (hashtable*)malloc(sizeof(hashtable));
     if (!tab)
         return NULL;
 
-    for (int i = 0; i < P; i++)
-        tab->tab[i] = NULL;
+    if (!init_table(&tab->current, INITIAL_CAPACITY)) {
+        free(tab);
+        return NULL;
+    }
+
+    tab->previous.capacity = 0;
+    tab->previous.size = 0;
+    tab->previous.ctrl = NULL;
+    tab->previous.slots = NULL;
+    tab->migrated = 0;
 
     return tab;
 }
 
+/* Stałe mieszające haszowania słowami (jak w wyhash). */
+#define HASH_P0 UINT64_C(0xa0761d6478bd642f)
+#define HASH_P1 UINT64_C(0xe7037ed1a0b428db)
+#define HASH_P2 UINT64_C(0x8ebc6af09c88c6e3)
 
-int hash_word(const char* s, int p) {
-    int w = 0;
-    int x = 1;
-
-    for (int i = 0; s[i]; i++) {
-        w += ((s[i] + N_OF_LETTERS) * x) % p;
-        w %= p;
+/* Mnoży dwie liczby 64-bitowe i składa obie połowy 128-bitowego wyniku. */
+static uint64_t hash_mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    return lo ^ hi;
+#endif
+}
 
-        x *= N_OF_LETTERS;
-        x %= p;
-    }
+static uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
 
-    return w;
+static uint64_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
 }
 
-bool add_hash(hashtable* tab, int hash, City* v) {
-    if(!tab->tab[hash]) {
-        tab->tab[hash] = new_list(v);
-        if (!tab->tab[hash]) {
-            return false;
+size_t hash_name(const char* s, size_t length) {
+    const unsigned char* p = (const unsigned char*)s;
+    uint64_t seed = HASH_P0;
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t x = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + x);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - x);
+        }
+        else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) |
+                p[length - 1];
+            b = 0;
+        }
+        else {
+            a = b = 0;
         }
     }
     else {
-        if(!add_elem(tab->tab[hash], v)) {
-            return false;
-        }
+        size_t i = length;
+        for (; i > 16; i -= 16, p += 16)
+            seed = hash_mix(read64(p) ^ HASH_P1, read64(p + 8) ^ seed);
 
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
     }
 
-    return true;
+    return (size_t)hash_mix(HASH_P1 ^ length,
+                            hash_mix(a ^ HASH_P1, b ^ seed ^ HASH_P2));
 }
 
-bool add_city(hashtable* tab, const char* s, City* v) {
-    int hash = hash_word(s, P);
+size_t hash_word(const char* s) {
+    return hash_name(s, strlen(s));
+}
+
+city_key make_city_key(const char* s) {
+    city_key key;
+
+    key.name = s;
+    key.length = strlen(s);
+    key.hash = hash_name(s, key.length);
 
-    return add_hash(tab, hash, v);
+    return key;
 }
 
-City* get_city_id(hashtable* tab, const char* s) {
-    int hash = hash_word(s, P);
+bool same_city_key(const city_key* k1, const city_key* k2) {
+    return k1->hash == k2->hash && k1->length == k2->length &&
+           memcmp(k1->name, k2->name, k1->length) == 0;
+}
 
-    list* l = tab->tab[hash];
-    l = first_elem(l);
+bool add_hash(hashtable* tab, size_t hash, City* v) {
+    migrate(tab, MIGRATION_STEP);
 
-    while (l) {
-        if (strcmp(l->city->city_name, s) == 0)
-            return l->city;
-        l = l->next;
+    if (8 * (tab->current.size + 1) > 7 * tab->current.capacity) {
+        city_table bigger;
+        if (!init_table(&bigger, 2 * tab->current.capacity))
+            return false;
+
+        migrate(tab, tab->previous.capacity);
+        tab->previous = tab->current;
+        tab->current = bigger;
+        tab->migrated = 0;
     }
 
-    return NULL;
+    table_insert(&tab->current, hash, v);
+
+    return true;
 }
 
-void free_cities(hashtable* tab) {
-    for (int i = 0; i < P; i++) {
-        list* l = tab->tab[i];
+bool add_city(hashtable* tab, const city_key* key, City* v) {
+    v->name_hash = key->hash;
+    return add_hash(tab, key->hash, v);
+}
 
-        while (l) {
-            City* c = l->city;
-            road_list* rl = c->roads;
+City* find_city_by_key(hashtable* tab, const city_key* key) {
+    City* c = table_find(&tab->current, key->hash, key->name, key->length);
+    if (!c)
+        c = table_find(&tab->previous, key->hash, key->name, key->length);
 
-            while (rl && rl->prev_road)
-                rl = rl->prev_road;
-            while (rl) {
-                road_list* rl_pom = rl->next_road;
-                free(remove_road(rl->road->city1, rl->road->city2));
-                rl = rl_pom;
-            }
+    return c;
+}
 
-            free(c->city_name);
-            free(c);
+City* get_city_id(hashtable* tab, const char* s) {
+    city_key key = make_city_key(s);
 
-            l = l->next;
-        }
+    return find_city_by_key(tab, &key);
+}
 
-        free_list(tab->tab[i]);
-    }
+void free_hashtable(hashtable* tab) {
+    if (!tab)
+        return;
 
-    free(tab->tab);
+    free_table(&tab->current);
+    free_table(&tab->previous);
+    free(tab);
 }
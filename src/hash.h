@@ -5,18 +5,37 @@
 #ifndef DROGI_HASH_H
 #define DROGI_HASH_H
 
-#include "list.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
 
-#define P 10007
+/** @brief Liczba miejsc w grupie sprawdzanej jednocześnie podczas szukania.
+ */
+#define GROUP_SIZE 16
 
-#define N_OF_LETTERS 300
+/** @brief Typ danych przechowujący tablicę z adresowaniem otwartym.
+ * Miejsca podzielone są na grupy po @ref GROUP_SIZE. Każde miejsce ma bajt
+ * kontrolny, który oznacza miejsce wolne, zwolnione albo zawiera siedem
+ * najmłodszych bitów hasza nazwy przechowywanego miasta. Dzięki temu
+ * całą grupę można porównać z szukanym haszem jedną operacją.
+ */
+typedef struct city_table {
+    size_t capacity; ///< Liczba miejsc, potęga dwójki, co najmniej GROUP_SIZE
+    size_t size; ///< Liczba zajętych miejsc
+    unsigned char* ctrl; ///< Bajty kontrolne kolejnych miejsc
+    City** slots; ///< Miasta w kolejnych miejscach
+} city_table;
 
 /** @brief Typ danych przechowujący hashmapę.
  * Kluczem są nazwy miast, a wartościami struktury miast odpowiadające
- * tym miastom.
+ * tym miastom. Gdy tablica się zapełnia, tworzona jest dwa razy większa,
+ * a miasta są do niej przenoszone stopniowo przy kolejnych wstawieniach,
+ * więc żadne pojedyncze wstawienie nie przenosi całej tablicy.
  */
 typedef struct hashtable {
-    list* tab[P]; /**< Tablica zawierająca listy oblicznonych haszy.*/
+    city_table current; ///< Tablica, do której wstawiane są nowe miasta
+    city_table previous; ///< Przenoszona tablica lub pusta tablica
+    size_t migrated; ///< Liczba sprawdzonych miejsc tablicy @p previous
 } hashtable;
 
 /** @brief Tworzy nową haszmapę.
@@ -25,32 +44,76 @@ typedef struct hashtable {
  */
 hashtable* new_hashtable();
 
+/** @brief Typ danych przechowujący nazwę miasta razem z jej długością
+ * i haszem.
+ * Pozwala policzyć hasza nazwy raz na polecenie i używać go we wszystkich
+ * wyszukiwaniach miasta w tym poleceniu.
+ */
+typedef struct city_key {
+    const char* name; ///< Nazwa miasta
+    size_t length; ///< Długość nazwy miasta
+    size_t hash; ///< Hasz nazwy miasta
+} city_key;
+
+/** @brief Liczy hasza dla napisu o podanej długości.
+ * Liczy 64-bitowego hasza, czytając napis po osiem bajtów (metodą
+ * podobną do wyhash).
+ * @param [in] s        - wskaźnik na napis;
+ * @param [in] length   - długość napisu @p s.
+ * @return Zwraca hasza napisu @p s.
+ */
+size_t hash_name(const char* s, size_t length);
+
 /** @brief Liczy hasza dla podaego słowa.
- * Liczy hasza słowa @p s dla bazy haszowania @p p.
- * @param [in] s        - wskaźnik na słowo;
- * @param [in] p        - liczba całkowita będąca bazą haszowania.
- * @return Zwraca hasza słowa @p s w bazie @p p.
+ * @param [in] s        - wskaźnik na słowo.
+ * @return Zwraca hasza słowa @p s, taki sam jak @ref hash_name.
+ */
+size_t hash_word(const char* s);
+
+/** @brief Tworzy klucz dla nazwy miasta.
+ * Liczy długość i hasza nazwy @p s. Klucz wskazuje na @p s, więc jest ważny
+ * dopóki napis @p s nie zostanie zwolniony.
+ * @param [in] s        - wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Zwraca klucz nazwy @p s.
+ */
+city_key make_city_key(const char* s);
+
+/** @brief Sprawdza, czy dwa klucze opisują tę samą nazwę.
+ * @param [in] k1       - wskaźnik na klucz nazwy miasta;
+ * @param [in] k2       - wskaźnik na klucz nazwy miasta.
+ * @return Zwraca @p true jeżeli nazwy są równe, @p false w przeciwnym
+ * wypadku.
  */
-int hash_word(const char* s, int p);
+bool same_city_key(const city_key* k1, const city_key* k2);
 
 /** @brief Dodaje wartość do tablicy.
  * Dodaje wartość @p city do haszmapy @p tab z kluczem @p hash.
  * @param [in, out] tab      - wskaźnik na haszmapę;
- * @param [in] hash          - liczba będąca kluczem @p city;
+ * @param [in] hash          - hasz nazwy miasta @p city;
  * @param [in] city          - wskaźnik na strukturę reprezentującą miasto.
  * @return Zwraca @p true jeżeli wartość została dodana do haszmapy. Zwraca
  * @p false w przeciwnym wypadku: nie udało się zaalokować pamięci.
  */
-bool add_hash(hashtable* tab, int hash, City* city);
+bool add_hash(hashtable* tab, size_t hash, City* city);
 
 /** @brief Dodaje miasto do haszmapy.
+ * Zapisuje w mieście hasz jego nazwy.
  * @param[in, out] tab       - wskaźnik na haszmapę;
- * @param[in] s              - wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] key            - wskaźnik na klucz nazwy miasta;
  * @param[in] city           - wskaźnik na strukturę reprezentującą miasto.
  *  @return Zwraca @p true jeżeli miasto zostało dodane do haszmapy lub
  *  @p false jeżeli nie udało się zaalokować pamięci.
  */
-bool add_city(hashtable* tab, const char* s, City* city);
+bool add_city(hashtable* tab, const city_key* key, City* city);
+
+/** @brief Znajduje w haszmapie miasto o nazwie opisanej kluczem.
+ * Nie liczy ponownie hasza nazwy.
+ * @param [in] tab            - wskaźnik na haszmapę;
+ * @param [in] key            - wskaźnik na klucz nazwy miasta.
+ * @return Zwraca wskaźnik na strukturę reprezentującą miasto o podanej
+ * nazwie lub @p NULL, jeżeli takiego miasta nie ma w haszmapie.
+ */
+City* find_city_by_key(hashtable* tab, const city_key* key);
 
 /** @brief Znajduje wartość w haszmapie dla podanego klucza..
  * @param [in] tab            - wskaźnik na haszmapę;
@@ -60,11 +123,12 @@ bool add_city(hashtable* tab, const char* s, City* city);
  * @p NULL w przeciwnym wypadku.
  */
 City* get_city_id(hashtable* tab, const char* s);
+
 /** @brief Usuwa haszmapę.
- *  Zwalnia z pamięci wszystkie wartości i klucze zawarte w haszmapie.
+ *  Zwalnia z pamięci haszmapę, nie zwalnia przechowywanych w niej miast.
  *  Nie robi nic jeżeli @p tab miało wartość @p NULL.
  * @param [in]tab       - wskaźnik na haszmapę;
  */
-void free_cities(hashtable* tab);
+void free_hashtable(hashtable* tab);
 
 #endif //DROGI_HASH_H
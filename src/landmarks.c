@@ -0,0 +1,213 @@
+#include "landmarks.h"
+#include <stdlib.h>
+#include <limits.h>
+
+#define INFINITE_LENGTH UINT_MAX
+
+/* Tablice są budowane od nowa, gdy od ich zbudowania usunięto więcej niż
+ * tę część odcinków. */
+#define REBUILD_FRACTION 16
+
+void free_landmarks(landmarks* lm) {
+    if (!lm)
+        return;
+
+    free(lm->distance);
+    free_priority_queue(lm->queue);
+    free(lm);
+}
+
+/* Powiększa tablicę odległości tak, żeby mieściła @p n_of_cities miast.
+ * Nowe miasta nie są połączone z żadnym miastem orientacyjnym. */
+static bool reserve_cities(landmarks* lm, size_t n_of_cities) {
+    if (n_of_cities > lm->capacity) {
+        size_t capacity = 2 * lm->capacity;
+        if (capacity < n_of_cities)
+            capacity = n_of_cities;
+
+        unsigned* distance = (unsigned*)realloc(lm->distance,
+                                                capacity * lm->count *
+                                                sizeof(unsigned));
+        if (!distance)
+            return false;
+        lm->distance = distance;
+
+        priority_queue* q = make_priority_queue(capacity);
+        if (!q)
+            return false;
+        free_priority_queue(lm->queue);
+        lm->queue = q;
+
+        lm->capacity = capacity;
+    }
+
+    for (size_t i = lm->n_of_cities * lm->count; i < n_of_cities * lm->count;
+         i++)
+        lm->distance[i] = INFINITE_LENGTH;
+    if (n_of_cities > lm->n_of_cities)
+        lm->n_of_cities = n_of_cities;
+
+    return true;
+}
+
+/* Poprawia odległości w kolumnie @p column od miast z kolejki, dopóki
+ * kolejka nie jest pusta. */
+static bool propagate(landmarks* lm, size_t column) {
+    priority_queue* q = lm->queue;
+
+    while (!is_empty(q)) {
+        path_priority pp = pop(q);
+        City* c = pp.city;
+
+        for (road_list* rl = c->roads; rl; rl = rl->next_road) {
+            Road* road = rl->road;
+            City* next = (road->city1 == c) ? road->city2 : road->city1;
+            unsigned* d = &lm->distance[next->city_id * lm->count + column];
+            unsigned length = pp.total_length + road->length;
+
+            if (length < pp.total_length || length >= *d)
+                continue;
+
+            *d = length;
+            if (!add(q, make_path(next, INT_MAX, length))) {
+                clear_priority_queue(q);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Liczy w kolumnie @p column odległości od miasta @p source. */
+static bool distances_from(landmarks* lm, size_t column, City* source) {
+    for (size_t v = 0; v < lm->n_of_cities; v++)
+        lm->distance[v * lm->count + column] = INFINITE_LENGTH;
+
+    lm->distance[source->city_id * lm->count + column] = 0;
+    return add(lm->queue, make_path(source, INT_MAX, 0)) &&
+           propagate(lm, column);
+}
+
+landmarks* build_landmarks(City** cities, size_t n_of_cities, size_t count) {
+    landmarks* lm = (landmarks*)calloc(1, sizeof(landmarks));
+    if (!lm)
+        return NULL;
+
+    /* Ostatnia kolumna przechowuje w trakcie wyboru odległość od najbliższego
+     * wybranego miasta. */
+    lm->count = count + 1;
+    unsigned* nearest = (unsigned*)malloc((n_of_cities + 1) *
+                                          sizeof(unsigned));
+    if (!nearest || !reserve_cities(lm, n_of_cities)) {
+        free(nearest);
+        free_landmarks(lm);
+        return NULL;
+    }
+
+    City* source = NULL;
+    for (size_t v = 0; v < n_of_cities; v++) {
+        if (cities[v]->n_of_roads > 0 &&
+            (!source || cities[v]->n_of_roads > source->n_of_roads))
+            source = cities[v];
+    }
+
+    bool ok = true;
+    if (source) {
+        ok = distances_from(lm, count, source);
+        for (size_t v = 0; v < n_of_cities; v++)
+            nearest[v] = lm->distance[v * lm->count + count];
+    }
+
+    while (ok && source && lm->n_of_landmarks < count) {
+        source = NULL;
+        for (size_t v = 0; v < n_of_cities; v++) {
+            if (nearest[v] != INFINITE_LENGTH && nearest[v] > 0 &&
+                (!source || nearest[v] > nearest[source->city_id]))
+                source = cities[v];
+        }
+
+        if (!source)
+            break;
+
+        size_t column = lm->n_of_landmarks++;
+        ok = distances_from(lm, column, source);
+
+        for (size_t v = 0; ok && v < n_of_cities; v++) {
+            unsigned d = lm->distance[v * lm->count + column];
+            if (d < nearest[v])
+                nearest[v] = d;
+        }
+    }
+
+    free(nearest);
+    if (!ok) {
+        free_landmarks(lm);
+        return NULL;
+    }
+
+    return lm;
+}
+
+bool landmarks_add_road(landmarks* lm, size_t n_of_cities, Road* road) {
+    if (!reserve_cities(lm, n_of_cities))
+        return false;
+
+    City* ends[2] = {road->city1, road->city2};
+
+    for (size_t i = 0; i < lm->n_of_landmarks; i++) {
+        for (int j = 0; j < 2; j++) {
+            unsigned d1 = lm->distance[ends[j]->city_id * lm->count + i];
+            unsigned* d2 = &lm->distance[ends[1 - j]->city_id * lm->count + i];
+            unsigned length = d1 + road->length;
+
+            if (d1 == INFINITE_LENGTH || length < d1 || length >= *d2)
+                continue;
+
+            *d2 = length;
+            if (!add(lm->queue, make_path(ends[1 - j], INT_MAX, length)) ||
+                !propagate(lm, i))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void landmarks_remove_road(landmarks* lm) {
+    lm->n_of_removed++;
+}
+
+void landmarks_restore_road(landmarks* lm) {
+    /* Tablice zbudowane po usunięciu odcinka go nie liczą. */
+    if (lm->n_of_removed > 0)
+        lm->n_of_removed--;
+}
+
+bool landmarks_outdated(landmarks* lm, size_t n_of_roads) {
+    return lm->n_of_removed > n_of_roads / REBUILD_FRACTION;
+}
+
+unsigned landmark_bound(landmarks* lm, City* from, City* to) {
+    if (from->city_id >= lm->n_of_cities || to->city_id >= lm->n_of_cities)
+        return (lm->n_of_landmarks > 0) ? INFINITE_LENGTH : 0;
+
+    unsigned* d1 = &lm->distance[from->city_id * lm->count];
+    unsigned* d2 = &lm->distance[to->city_id * lm->count];
+    unsigned bound = 0;
+
+    for (size_t i = 0; i < lm->n_of_landmarks; i++) {
+        if (d1[i] == INFINITE_LENGTH || d2[i] == INFINITE_LENGTH) {
+            if (d1[i] != d2[i])
+                return INFINITE_LENGTH;
+
+            continue;
+        }
+
+        unsigned d = (d1[i] > d2[i]) ? d1[i] - d2[i] : d2[i] - d1[i];
+        if (d > bound)
+            bound = d;
+    }
+
+    return bound;
+}
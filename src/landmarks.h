@@ -0,0 +1,95 @@
+/** @file
+ * Biblioteka definiująca tablice odległości od miast orientacyjnych
+ * (landmarks), dające dolne ograniczenia długości dróg dla wyszukiwania A*.
+ */
+
+#ifndef DROGI_LANDMARKS_H
+#define DROGI_LANDMARKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "priority_queue.h"
+
+/** @brief Typ danych przechowujący odległości od miast orientacyjnych.
+ * Odległość miasta o numerze Id @p v od miasta orientacyjnego @p i jest
+ * zapisana w @p distance[v * count + i], więc odległości jednego miasta od
+ * wszystkich miast orientacyjnych leżą obok siebie. Wartość UINT_MAX
+ * oznacza, że miasto nie jest połączone z miastem orientacyjnym.
+ * Z nierówności trójkąta |d(L, t) - d(L, v)| nie przekracza długości
+ * najkrótszej drogi z @p v do @p t.
+ */
+typedef struct landmarks {
+    size_t count; ///< Liczba kolumn tablicy odległości, o jeden większa od
+    ///< największej liczby miast orientacyjnych
+    size_t n_of_landmarks; ///< Liczba wybranych miast orientacyjnych
+    size_t n_of_cities; ///< Liczba miast w tablicy odległości
+    size_t capacity; ///< Liczba miast, na które jest miejsce w tablicy
+    unsigned* distance; ///< Odległości od miast orientacyjnych
+    size_t n_of_removed; ///< Liczba odcinków usuniętych od zbudowania tablic
+    priority_queue* queue; ///< Kolejka używana przy liczeniu odległości
+} landmarks;
+
+/** @brief Wybiera miasta orientacyjne i liczy odległości od nich.
+ * Zaczyna od miasta o największej liczbie odcinków i wybiera kolejno
+ * miasto najdalsze od dotychczas wybranych, spośród miast z nimi
+ * połączonych.
+ * @param [in] cities       - Tablica miast w kolejności numerów Id;
+ * @param [in] n_of_cities  - Liczba miast;
+ * @param [in] count        - Największa liczba miast orientacyjnych.
+ * @return Zwraca wskaźnik na tablice lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+landmarks* build_landmarks(City** cities, size_t n_of_cities, size_t count);
+
+/** @brief Usuwa tablice odległości.
+ * Nic nie robi, jeżeli @p lm ma wartość NULL.
+ * @param [in, out] lm      - Wskaźnik na tablice odległości.
+ */
+void free_landmarks(landmarks* lm);
+
+/** @brief Uaktualnia odległości po dodaniu odcinka drogi.
+ * Odległości mogą tylko zmaleć, więc poprawia je jak algorytm Dijkstry
+ * zaczynający od końca odcinka, do którego znaleziono krótszą drogę.
+ * @param [in, out] lm      - Wskaźnik na tablice odległości;
+ * @param [in] n_of_cities  - Liczba miast;
+ * @param [in] road         - Dodany odcinek drogi.
+ * @return Zwraca @p true jeżeli udało się uaktualnić tablice, @p false
+ * jeżeli nie udało się zaalokować pamięci. Tablic nie można wtedy dalej
+ * używać.
+ */
+bool landmarks_add_road(landmarks* lm, size_t n_of_cities, Road* road);
+
+/** @brief Odnotowuje usunięcie odcinka drogi.
+ * Odległości w grafie bez odcinka są nie mniejsze niż zapisane, więc
+ * ograniczenia pozostają poprawne, choć słabsze.
+ * @param [in, out] lm      - Wskaźnik na tablice odległości.
+ */
+void landmarks_remove_road(landmarks* lm);
+
+/** @brief Odnotowuje przywrócenie usuniętego odcinka drogi.
+ * Cofa @ref landmarks_remove_road, żeby nieudane usuwanie odcinków nie
+ * przybliżało przebudowy tablic. Odległości poprawia osobno
+ * @ref landmarks_add_road.
+ * @param [in, out] lm      - Wskaźnik na tablice odległości.
+ */
+void landmarks_restore_road(landmarks* lm);
+
+/** @brief Sprawdza, czy tablice warto zbudować od nowa.
+ * @param [in] lm           - Wskaźnik na tablice odległości;
+ * @param [in] n_of_roads   - Liczba odcinków dróg.
+ * @return Zwraca @p true jeżeli od zbudowania tablic usunięto istotną część
+ * odcinków, @p false w przeciwnym wypadku.
+ */
+bool landmarks_outdated(landmarks* lm, size_t n_of_roads);
+
+/** @brief Wyznacza dolne ograniczenie długości drogi między miastami.
+ * @param [in] lm           - Wskaźnik na tablice odległości;
+ * @param [in] from         - Wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] to           - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca dolne ograniczenie długości najkrótszej drogi z @p from
+ * do @p to lub UINT_MAX, jeżeli miasta nie są połączone.
+ */
+unsigned landmark_bound(landmarks* lm, City* from, City* to);
+
+#endif //DROGI_LANDMARKS_H
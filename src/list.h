@@ -96,112 +96,10 @@ list* find_city(list* l, City* c);
  */
 bool exists(list* l, City* c);
 
-/** @brief Porównuje dwie drogi do siebie.
- * Porównuje dwa ciągi kolejnych miast do siebie pod względem długości oraz
- * lat ostatnich remontów. Każde dwa kolejne elementy listy są połączone drogą.
- * @param[in] path1        - wskaźnik na element listy dwukierunkowej;
- * @param[in] path2        - wskaźnik na element listy dwukierunkowej.
- * @return Zwraca @p 0 jeżeli drogi są tej samej długości i najstarszy
- * odcinek jest w obu równie stary. Zwraca liczbę dodatnią, jeżeli pierwsza droga
- * jest krótsza od drugiej lub, w przypadku równych długości, najstarszy odcinek drogi
- * zawarty w pierwszej drodze jest młodszy od najstarszego odcinka drogi zawartego w
- * drugiej drodze. Zwraca liczę ujemną wprzeciwnym wypaku.
- */
-int compare_paths(list* path1, list* path2);
-
-/** @brief Uzupełnia jedną drogę o dodatkowe odcinki.
- * Uzupełnia drogę route o drogę zawartą w @p l. Pewne dwa kolejne miasta w
- * route są odpowiednio pierwszym i ostatnim elementem listy @p l i to
- * w ich miejsce wstawiana jest lista @p l.
- * @param [in, out] route   - wskaźnik na element listy dwukierunkowej;
- * @param [in] l            - wskaźnik na element listy dwukierunkowej.
- */
-void fill_gap(list* route, list* l);
-
-/** @brief Znajduje długośc drogi.
- * Znajduje długośc drogi reprezentowanej jako ciąg kolejnych jej miast w
- * liście @p route.
- * są odpowiednio pierwszym i ostatnim elementem listy @p l i to w ich miejsce
- * wstawiana jest lista @p l.
- * @param [in, out] route   - wskaźnik na element listy dwukierunkowej;
- * @return Zwraca długość drogi przedstawionej w @p route. Zwraca @p 0 jeżeli
- * taka droga nie istnieje.
- */
-unsigned route_length(list* l);
-
-/** @brief Znajduje najstarszy odcinek drogi w drodze.
- * Znajduje najstarszy odcinek drogi w drodze reprezentowanej jako ciąg
- * kolejnych miast, przez które ta droga przechodzi.
- * są odpowiednio pierwszym i ostatnim elementem listy @p l i to w ich miejsce
- * wstawiana jest lista @p l.
- * @param [in, out] route   - wskaźnik na element listy dwukierunkowej;
- * @return Zwraca rok ostatniego remontu lub budowy najstarszego odcinka drogi
- * przedstawionej w @p route. Zwraca @p 0 jeżeli taka droga nie istnieje.
- */
-int route_repair(list* l);
-
-/** @brief Wydłuża jedną drogę o dodatkowe odcinki.
- * Wydłuża drogę route o drogę extension. Droga extenion zostaje doklejona
- * na koniec listy l.
- * wstawiana jest lista l.
- * @param [in, out] route   - wskaźnik na element listy dwukierunkowej;
- * @param [in] extension    - wskaźnik na element listy dwukierunkowej.
- * @return Zwraca wskaźnik na wydłużoną listę.
- */
-list* extend_path(list* route, list* extension);
-/** @brief Sprawdza czy droga zawiera odcinek drogi.
- * @param [in] route            - wskaźnik na element listy dwukierunkowej;
- * @param [in] city1            - wskaźnik na strukturę reprezentującą miasto;
- * @param [in] city2            - wskaźnik na strukturę reprezentującą miasto.
- * @return Zwraca @p true, jeżeli droga zawiera odcinek drogi, @p false w
- * przeciwnym wypadku.
- */
-bool containsRoad(list* route, City* city1, City* city2);
-
-/** @brief Dodaje napis na podane miejsce do tablicy.
- * Wstawia napis @p string w napis @p description w taki sposób, że słowo
- * @p string zaczyna się w słowie @ description na indeksie @p index.
- * @param [in, out] description   - wskaźnik na tworzący się
- * napis opisu drogi krajowej;
- * @param [in] string             - wskaźnik na niepusty napis.
- * @param [in] index              - wskaźnik na liczbę całkowitą
- * z zakresu @p description.
- */
-void add_at_index(char* description, const char* string, size_t *index);
-
-/** @brief Zwraca liczbę całkowitą liczbę znaków potrzebnych do
- * opisania drogi krajowej.
- * @param [in] route   - wskaźnik na listę reprezentującą drogę.
- * @return Zwraca nieujemną liczbę całkowitą, która jest dokładną ilością znaków,
- * jaką będzie zawierać opis drogi przedstawionej w @p route.
- */
-size_t describeRoute_length(list* route);
-
-/** @brief Zwraca wskaźnik na napis opisujący drogę krajową.
- *
- * Zwraca wskaźnik na napis, który zawiera informacje o drodze krajowej. Alokuje
- * pamięć na ten napis. Informacje są podawane w tej samej kolejności, co miasta
- * w route.
- * Informacje wypisywane są w formacie:
- * numer drogi krajowej;nazwa miasta;długość odcinka drogi;rok budowy lub
- * ostatniego remontu;nazwa miasta;długość odcinka drogi;rok budowy lub
- * ostatniego remontu;nazwa miasta;…;nazwa miasta.
- * @param [in] route   - wskaźnik na element listy dwukierunkowej;
- * @param [in] routeId - nieujemna liczba reprezentująca numer drogi krajowej.
- * @return Zwraca wskaźnik na napis opisujący drogę krajową.
- */
-char* describeRoute(list* route, unsigned routeId);
-
 /** @brief Usuwa listę i zwalnia zaalokowaną dla niej pamięć.
  * Nie robi nic, jeżeli lista była już pusta.
  * @param [in] list   - wskaźnik na element listy dwukierunkowej.
  */
 void free_list(list* l);
 
-/** @Brief Usuwa i zwalnia z pamięci tablicę list dwukierunkowych, ustawia
- * @p l na @p NULL.
- *
- * @param [in, out] l   - tablica list dwukierunkowych.
- */
-void free_routes(list** l);
 #endif //DROGI_LIST_H
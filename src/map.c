@@ -4,22 +4,81 @@
 
 #include "map.h"
 #include "list.h"
+#include "national_route.h"
 #include "priority_queue.h"
 #include "hash.h"
 #include "graph_operations.h"
+#include "search_workspace.h"
+#include "graph_snapshot.h"
+#include "contraction_hierarchy.h"
+#include "landmarks.h"
+#include "route_index.h"
+#include "worker_pool.h"
+#include "path_cache.h"
+#include "path_tree.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 
 #define MAX_ROUTES 1000
 
+#define DEFAULT_LANDMARKS 8
+
+#define PATH_CACHE_SIZE 256
+
+/** @brief Typ danych opisujący miasto, z którego mapa utrzymuje drzewo
+ * najlepszych dróg.
+ */
+typedef struct hot_city {
+    City* city; ///< Miasto początkowe
+    path_tree* tree; ///< Drzewo najlepszych dróg lub NULL, jeżeli nie
+    ///< zostało jeszcze zbudowane
+} hot_city;
+
 struct Map {
-    list* routes[MAX_ROUTES];
+    national_route* routes[MAX_ROUTES];
 
     hashtable* city_id;
 
     int n_of_cities;
+
+    City** cities;
+
+    size_t cities_capacity;
+
+    size_t n_of_roads;
+
+    search_workspace* workspace;
+
+    graph_snapshot* snapshot;
+
+    contraction_hierarchy* hierarchy;
+
+    size_t hierarchy_retry;
+
+    landmarks* landmarks;
+
+    size_t n_of_landmarks;
+
+    graph_memory memory;
+
+    object_pool route_uses;
+
+    size_t n_of_workers;
+
+    worker_pool* workers;
+
+    search_workspace** worker_workspaces;
+
+    path_cache* paths;
+
+    unsigned long graph_epoch;
+
+    hot_city* hot_cities;
+
+    size_t n_of_hot_cities;
 };
 
 Map* newMap() {
@@ -28,18 +87,409 @@ Map* newMap() {
         return NULL;
 
     m->n_of_cities = 0;
+    m->cities = NULL;
+    m->cities_capacity = 0;
+    m->n_of_roads = 0;
+    m->snapshot = NULL;
+    m->hierarchy = NULL;
+    m->hierarchy_retry = 0;
+    m->landmarks = NULL;
+    m->n_of_landmarks = DEFAULT_LANDMARKS;
+    init_graph_memory(&m->memory);
+    init_route_uses(&m->route_uses);
+    m->n_of_workers = default_worker_count();
+    m->workers = NULL;
+    m->worker_workspaces = NULL;
+    m->paths = NULL;
+    m->graph_epoch = 0;
+    m->hot_cities = NULL;
+    m->n_of_hot_cities = 0;
     m->city_id = new_hashtable();
     if (!m->city_id) {
         free(m);
         return NULL;
     }
 
+    m->workspace = new_search_workspace();
+    if (!m->workspace) {
+        free_hashtable(m->city_id);
+        free(m);
+        return NULL;
+    }
+
     for (int i = 0; i < MAX_ROUTES; i++)
         m->routes[i] = NULL;
 
     return m;
 }
 
+/** @brief Zaznacza, że graf dróg się zmienił.
+ * Unieważnia migawkę grafu i zapamiętane wyniki wyszukiwań oraz zeruje
+ * licznik pracy wykonanej od ostatniej zmiany grafu.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ */
+static void graph_changed(Map* map) {
+    map->graph_epoch++;
+    free_graph_snapshot(map->snapshot);
+    map->snapshot = NULL;
+    map->workspace->work = 0;
+}
+
+/** @brief Zwraca migawkę grafu, której mogą użyć wyszukiwania.
+ * Migawka jest budowana dopiero wtedy, gdy wyszukiwania od ostatniej zmiany
+ * grafu przejrzały łącznie tyle miast i odcinków, ile kosztuje jej
+ * zbudowanie. Dzięki temu przy częstych zmianach grafu koszt budowania
+ * migawek jest co najwyżej proporcjonalny do kosztu samych wyszukiwań.
+ * W trybie @ref SEARCH_PARALLEL migawka jest budowana od razu, bo tylko
+ * z niej czyta graf wyszukiwanie dzielone pomiędzy wątki.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na aktualną migawkę grafu lub NULL.
+ */
+static graph_snapshot* current_snapshot(Map* map) {
+    if (!map->snapshot &&
+        (map->workspace->mode == SEARCH_PARALLEL ||
+         map->workspace->work >= map->n_of_cities + 2 * map->n_of_roads))
+        map->snapshot = build_graph_snapshot(map->cities, map->n_of_cities,
+                                             map->n_of_roads);
+
+    return map->snapshot;
+}
+
+/** @brief Zwraca pamięć podręczną wyników wyszukiwań dróg.
+ * Pamięć jest tworzona przy pierwszym użyciu, a wyniki zapamiętane przed
+ * ostatnią zmianą grafu są z niej usuwane.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na pamięć podręczną lub NULL, gdy nie udało się jej
+ * utworzyć.
+ */
+static path_cache* current_paths(Map* map) {
+    if (!map->paths)
+        map->paths = new_path_cache(PATH_CACHE_SIZE);
+
+    if (map->paths)
+        path_cache_sync(map->paths, map->graph_epoch);
+
+    return map->paths;
+}
+
+/** @brief Zwraca hierarchię skrótów, której mogą użyć wyszukiwania.
+ * Hierarchia jest budowana przy pierwszym wyszukiwaniu w trybie
+ * @ref SEARCH_CONTRACTION, a potem uaktualniana przy zmianach grafu.
+ * Jeżeli budowa się nie uda, bo graf nie ma małych separatorów i budowa
+ * przekroczyła limit pracy, to jest ponawiana dopiero po podwojeniu liczby
+ * odcinków, więc koszt nieudanych budów jest proporcjonalny do rozmiaru
+ * grafu.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na aktualną hierarchię lub NULL, gdy wyszukiwania jej nie
+ * używają lub nie udało się jej zbudować.
+ */
+static contraction_hierarchy* current_hierarchy(Map* map) {
+    if (!map->hierarchy && map->workspace->mode == SEARCH_CONTRACTION &&
+        map->n_of_roads >= map->hierarchy_retry) {
+        map->hierarchy = build_contraction_hierarchy(map->cities,
+                                                     map->n_of_cities,
+                                                     map->n_of_roads);
+        if (!map->hierarchy)
+            map->hierarchy_retry = 2 * map->n_of_roads + 1;
+    }
+
+    return map->hierarchy;
+}
+
+/** @brief Usuwa hierarchię skrótów.
+ * Jeżeli wyszukiwania jej używają, zostanie zbudowana od nowa przy
+ * następnym wyszukiwaniu.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ */
+static void drop_hierarchy(Map* map) {
+    free_contraction_hierarchy(map->hierarchy);
+    map->hierarchy = NULL;
+}
+
+/** @brief Usuwa tablice odległości od miast orientacyjnych.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ */
+static void drop_landmarks(Map* map) {
+    free_landmarks(map->landmarks);
+    map->landmarks = NULL;
+}
+
+/** @brief Zwraca tablice odległości od miast orientacyjnych, których mogą
+ * użyć wyszukiwania.
+ * Tablice są budowane przy pierwszym wyszukiwaniu w trybie
+ * @ref SEARCH_LANDMARKS i uaktualniane przy dodawaniu odcinków. Po
+ * usunięciu odcinków pozostają poprawne, ale słabsze, więc są budowane od
+ * nowa dopiero, gdy usunięto ich dużo.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na aktualne tablice lub NULL, gdy wyszukiwania ich nie
+ * używają lub nie udało się zaalokować pamięci.
+ */
+static landmarks* current_landmarks(Map* map) {
+    if (map->workspace->mode != SEARCH_LANDMARKS)
+        return NULL;
+
+    if (map->landmarks && landmarks_outdated(map->landmarks, map->n_of_roads))
+        drop_landmarks(map);
+
+    if (!map->landmarks)
+        map->landmarks = build_landmarks(map->cities, map->n_of_cities,
+                                         map->n_of_landmarks);
+
+    return map->landmarks;
+}
+
+/** @brief Kończy wątki uzupełniające drogi krajowe i usuwa ich pamięć
+ * roboczą.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ */
+static void drop_workers(Map* map) {
+    free_worker_pool(map->workers);
+    map->workers = NULL;
+
+    if (map->worker_workspaces) {
+        for (size_t i = 1; i < map->n_of_workers; i++)
+            free_search_workspace(map->worker_workspaces[i - 1]);
+
+        free(map->worker_workspaces);
+        map->worker_workspaces = NULL;
+    }
+}
+
+/** @brief Zwraca pulę wątków, które mogą równolegle uzupełniać drogi
+ * krajowe.
+ * Pula i pamięć robocza jej wątków są tworzone przy pierwszym użyciu.
+ * Wątek o numerze 0 używa pamięci roboczej mapy.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na pulę lub NULL, gdy mapa ma używać jednego wątku lub
+ * nie udało się utworzyć puli.
+ */
+static worker_pool* current_workers(Map* map) {
+    if (map->workers || map->n_of_workers < 2)
+        return map->workers;
+
+    map->worker_workspaces =
+        (search_workspace**)calloc(map->n_of_workers - 1,
+                                   sizeof(search_workspace*));
+    if (!map->worker_workspaces)
+        return NULL;
+
+    for (size_t i = 1; i < map->n_of_workers; i++) {
+        map->worker_workspaces[i - 1] = new_search_workspace();
+        if (!map->worker_workspaces[i - 1]) {
+            drop_workers(map);
+            return NULL;
+        }
+    }
+
+    map->workers = new_worker_pool(map->n_of_workers);
+    if (!map->workers)
+        drop_workers(map);
+
+    return map->workers;
+}
+
+/** @brief Zwraca pamięć roboczą wątku.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] worker      – numer wątku puli.
+ * @return Wskaźnik na pamięć roboczą wątku.
+ */
+static search_workspace* worker_workspace(Map* map, size_t worker) {
+    return (worker == 0) ? map->workspace : map->worker_workspaces[worker - 1];
+}
+
+/** @brief Zwraca miasto o podanym numerze Id.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] city        – numer Id miasta.
+ * @return Wskaźnik na miasto lub NULL, jeżeli nie ma miasta o tym numerze.
+ */
+static City* city_by_id(Map* map, unsigned city) {
+    if (city >= (unsigned)map->n_of_cities)
+        return NULL;
+
+    return map->cities[city];
+}
+
+/** @brief Znajduje opis miasta, z którego mapa utrzymuje drzewo najlepszych
+ * dróg.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] city        – wskaźnik na miasto.
+ * @return Wskaźnik na opis miasta lub NULL, jeżeli mapa nie utrzymuje
+ * drzewa z @p city.
+ */
+static hot_city* find_hot_city(Map* map, City* city) {
+    for (size_t i = 0; i < map->n_of_hot_cities; i++) {
+        if (map->hot_cities[i].city == city)
+            return &map->hot_cities[i];
+    }
+
+    return NULL;
+}
+
+/** @brief Zwraca drzewo najlepszych dróg z miasta.
+ * Drzewo jest budowane przy pierwszym użyciu, a potem uaktualniane przy
+ * zmianach grafu.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] city        – wskaźnik na miasto.
+ * @return Wskaźnik na aktualne drzewo lub NULL, gdy mapa nie utrzymuje
+ * drzewa z @p city lub nie udało się zaalokować pamięci.
+ */
+static path_tree* current_tree(Map* map, City* city) {
+    hot_city* h = find_hot_city(map, city);
+    if (!h)
+        return NULL;
+
+    if (!h->tree)
+        h->tree = new_path_tree(map->workspace, city, map->n_of_cities);
+
+    return h->tree;
+}
+
+/** @brief Uaktualnia drzewa najlepszych dróg po zmianie odcinka drogi.
+ * Drzewo, którego nie udało się uaktualnić, zostanie zbudowane od nowa
+ * przy następnym użyciu.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] road        – dodany, wyremontowany lub odłączony odcinek;
+ * @param [in] removed     – czy odcinek został odłączony od grafu.
+ */
+static void update_trees(Map* map, Road* road, bool removed) {
+    for (size_t i = 0; i < map->n_of_hot_cities; i++) {
+        path_tree* t = map->hot_cities[i].tree;
+        if (!t)
+            continue;
+
+        bool ok = removed ?
+            path_tree_remove_road(t, map->workspace, road, map->n_of_cities) :
+            path_tree_improve_road(t, map->workspace, road, map->n_of_cities);
+
+        if (!ok) {
+            free_path_tree(t);
+            map->hot_cities[i].tree = NULL;
+        }
+    }
+}
+
+/** @brief Ustawia, czy mapa utrzymuje drzewo najlepszych dróg z miasta.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] city        – wskaźnik na miasto lub NULL;
+ * @param [in] hot         – czy mapa ma utrzymywać drzewo.
+ * @return Wartość @p true, jeśli ustawienie się powiodło, @p false
+ * w przypadkach opisanych w @ref mapSetHotCity.
+ */
+static bool set_hot_city(Map* map, City* city, bool hot) {
+    if (!city)
+        return false;
+
+    hot_city* h = find_hot_city(map, city);
+    if (!hot) {
+        if (h) {
+            free_path_tree(h->tree);
+            *h = map->hot_cities[--map->n_of_hot_cities];
+        }
+        return true;
+    }
+
+    if (h)
+        return true;
+
+    hot_city* cities = (hot_city*)realloc(map->hot_cities,
+                                          (map->n_of_hot_cities + 1) *
+                                          sizeof(hot_city));
+    if (!cities)
+        return false;
+
+    map->hot_cities = cities;
+    map->hot_cities[map->n_of_hot_cities].city = city;
+    map->hot_cities[map->n_of_hot_cities].tree = NULL;
+    map->n_of_hot_cities++;
+
+    return true;
+}
+
+/** @brief Dodaje do mapy nowe miasto.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] key         – wskaźnik na klucz nazwy miasta.
+ * @return Wskaźnik na dodane miasto lub NULL, gdy nie udało się zaalokować
+ * pamięci.
+ */
+static City* add_new_city(Map* map, const city_key* key) {
+    if ((size_t)map->n_of_cities == map->cities_capacity) {
+        size_t capacity = map->cities_capacity ? 2 * map->cities_capacity : 16;
+        City** cities = (City**)realloc(map->cities, capacity * sizeof(City*));
+        if (!cities)
+            return NULL;
+
+        map->cities = cities;
+        map->cities_capacity = capacity;
+    }
+
+    City* c = newCity(&map->memory, key->name, key->length, map->n_of_cities);
+    if (!c)
+        return NULL;
+
+    if (!add_city(map->city_id, key, c)) {
+        free_city(&map->memory, c);
+        return NULL;
+    }
+
+    map->cities[map->n_of_cities] = c;
+    map->n_of_cities++;
+
+    /* Migawka grafu nie zawiera nowego miasta. */
+    free_graph_snapshot(map->snapshot);
+    map->snapshot = NULL;
+
+    return c;
+}
+
+unsigned mapLookupCity(Map *map, const char *city) {
+    City* c = get_city_id(map->city_id, city);
+
+    return c ? c->city_id : NO_CITY;
+}
+
+unsigned mapAddCity(Map *map, const char *city) {
+    if (!valid_city(city))
+        return NO_CITY;
+
+    city_key key = make_city_key(city);
+    City* c = find_city_by_key(map->city_id, &key);
+    if (!c)
+        c = add_new_city(map, &key);
+
+    return c ? c->city_id : NO_CITY;
+}
+
+void mapSetSearchMode(Map *map, search_mode mode) {
+    map->workspace->mode = mode;
+
+    map->hierarchy_retry = 0;
+    if (mode != SEARCH_CONTRACTION)
+        drop_hierarchy(map);
+    if (mode != SEARCH_LANDMARKS)
+        drop_landmarks(map);
+}
+
+void mapSetLandmarkCount(Map *map, unsigned count) {
+    map->n_of_landmarks = count;
+    drop_landmarks(map);
+}
+
+void mapSetWorkerCount(Map *map, unsigned count) {
+    drop_workers(map);
+    map->n_of_workers = (count > 0) ? count : 1;
+}
+
+bool mapSetHotCity(Map *map, const char *city, bool hot) {
+    if (!valid_city(city))
+        return false;
+
+    return set_hot_city(map, get_city_id(map->city_id, city), hot);
+}
+
+bool mapSetHotCityById(Map *map, unsigned city, bool hot) {
+    return set_hot_city(map, city_by_id(map, city), hot);
+}
+
 bool valid_city(const char* city) {
     for (int i = 0; city[i]; i++) {
         if ((city[i] >= 0 && city[i] < 32) || city[i] == ';')
@@ -52,30 +502,99 @@ bool valid_city(const char* city) {
         return false;
 }
 
-bool valid_newRoute(Map* map, const char* city1, const char* city2) {
-
+/** @brief Znajduje końce nowej drogi krajowej.
+ * Sprawdza to samo co @ref valid_newRoute, licząc hasz każdej nazwy raz.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] city1       – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param [in] city2       – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param [out] c1         – miasto o nazwie @p city1;
+ * @param [out] c2         – miasto o nazwie @p city2.
+ * @return Zwraca @p true jeżeli może powstać droga krajowa pomiędzy
+ * miastami, @p false w przeciwnym wypadku.
+ */
+static bool route_endpoints(Map* map, const char* city1, const char* city2,
+                            City** c1, City** c2) {
     if (!valid_city(city1) || !valid_city(city2))
         return false;
 
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
+    *c1 = get_city_id(map->city_id, city1);
+    *c2 = get_city_id(map->city_id, city2);
 
-    if (!c1 || !c2)
+    if (!*c1 || !*c2)
         return false;
 
-    if (c1 == c2)
+    if (*c1 == *c2)
         return false;
 
     return true;
+}
 
+/** @brief Uwzględnia nowy odcinek drogi w strukturach pomocniczych mapy.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] road        – odcinek drogi dołączony do grafu.
+ */
+static void road_added(Map* map, Road* road) {
+    map->n_of_roads++;
+    if (road->length > map->workspace->max_length)
+        map->workspace->max_length = road->length;
+    graph_changed(map);
+    if (map->hierarchy &&
+        !hierarchy_add_road(map->hierarchy, map->cities, map->n_of_cities,
+                            road))
+        drop_hierarchy(map);
+    if (map->landmarks &&
+        !landmarks_add_road(map->landmarks, map->n_of_cities, road))
+        drop_landmarks(map);
+    update_trees(map, road, false);
 }
 
-bool valid_addRoad(Map *map, const char *city1, const char *city2,
-                   unsigned length, int builtYear) {
-    if (strcmp(city1, city2) == 0)
+/** @brief Dodaje odcinek drogi pomiędzy istniejącymi miastami.
+ * Nie sprawdza poprawności parametrów.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] c1          – wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] c2          – wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] length      – długość w km odcinka drogi;
+ * @param [in] builtYear   – rok budowy odcinka drogi.
+ * @return Wartość @p true, jeśli odcinek drogi został dodany lub @p false,
+ * gdy nie udało się zaalokować pamięci.
+ */
+static bool add_road_between(Map* map, City* c1, City* c2,
+                             unsigned length, int builtYear) {
+    if (!newRoad(&map->memory, c1, c2, length, builtYear))
         return false;
 
-    if (!valid_city(city1) || !valid_city(city2))
+    road_added(map, getRoad(c1, c2));
+
+    return true;
+}
+
+bool valid_newRoute(Map* map, const char* city1, const char* city2) {
+    City* c1;
+    City* c2;
+
+    return route_endpoints(map, city1, city2, &c1, &c2);
+}
+
+/** @brief Sprawdza, czy może powstać odcinek drogi i znajduje jego końce.
+ * Sprawdza to samo co @ref valid_addRoad, korzystając z policzonych
+ * wcześniej kluczy nazw.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] k1          – wskaźnik na klucz nazwy miasta;
+ * @param [in] k2          – wskaźnik na klucz nazwy miasta;
+ * @param [in] length      - długość w km odcinka drogi;
+ * @param [in] builtYear   – rok budowy odcinka drogi;
+ * @param [out] c1         – miasto o kluczu @p k1 lub NULL, jeżeli go nie ma;
+ * @param [out] c2         – miasto o kluczu @p k2 lub NULL, jeżeli go nie ma.
+ * @return Zwraca @p true, jeżeli można dodać odcinek drogi pomiędzy
+ * miastami. Zwraca @p false w przeciwnym wypadku.
+ */
+static bool road_endpoints(Map* map, const city_key* k1, const city_key* k2,
+                           unsigned length, int builtYear,
+                           City** c1, City** c2) {
+    if (same_city_key(k1, k2))
+        return false;
+
+    if (!valid_city(k1->name) || !valid_city(k2->name))
         return false;
 
     if (length <= 0)
@@ -84,55 +603,70 @@ bool valid_addRoad(Map *map, const char *city1, const char *city2,
     if (builtYear == 0)
         return false;
 
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
+    *c1 = find_city_by_key(map->city_id, k1);
+    *c2 = find_city_by_key(map->city_id, k2);
 
-    if (!c1 || !c2)
+    if (!*c1 || !*c2)
         return true;
 
-    if (areConnected(c1, c2))
+    if (areConnected(*c1, *c2))
         return false;
     return true;
 }
 
+bool valid_addRoad(Map *map, const char *city1, const char *city2,
+                   unsigned length, int builtYear) {
+    city_key k1 = make_city_key(city1);
+    city_key k2 = make_city_key(city2);
+    City* c1;
+    City* c2;
+
+    return road_endpoints(map, &k1, &k2, length, builtYear, &c1, &c2);
+}
+
 bool addRoad(Map *map, const char *city1, const char *city2,
              unsigned length, int builtYear) {
+    city_key k1 = make_city_key(city1);
+    city_key k2 = make_city_key(city2);
+    City* c1;
+    City* c2;
 
-    if (!valid_addRoad(map, city1, city2, length, builtYear))
+    if (!road_endpoints(map, &k1, &k2, length, builtYear, &c1, &c2))
         return false;
 
-    if (!get_city_id(map->city_id, city1)) {
-        City* c1 = newCity(city1, map->n_of_cities);
-
-        if (!add_city(map->city_id, c1->city_name, c1))
-            return false;
-        map->n_of_cities++;
-    }
-
-    if (!get_city_id(map->city_id, city2)) {
-        City* c1 = newCity(city2, map->n_of_cities);
+    if (!c1 && !(c1 = add_new_city(map, &k1)))
+        return false;
 
-        if (!add_city(map->city_id, city2, c1))
-            return false;
-        map->n_of_cities++;
-    }
+    if (!c2 && !(c2 = add_new_city(map, &k2)))
+        return false;
 
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
+    return add_road_between(map, c1, c2, length, builtYear);
+}
 
-    newRoad(c1, c2, length, builtYear);
+bool addRoadById(Map *map, unsigned city1, unsigned city2,
+                 unsigned length, int builtYear) {
+    City* c1 = city_by_id(map, city1);
+    City* c2 = city_by_id(map, city2);
 
-    return true;
-}
+    if (!c1 || !c2 || c1 == c2 || length <= 0 || builtYear == 0)
+        return false;
 
-bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear) {
-    if (!valid_city(city1) || !valid_city(city2))
+    if (areConnected(c1, c2))
         return false;
 
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
+    return add_road_between(map, c1, c2, length, builtYear);
+}
 
-    if (!c1 || !c2)
+/** @brief Modyfikuje rok ostatniego remontu odcinka drogi.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] c1          – wskaźnik na miasto lub NULL;
+ * @param [in] c2          – wskaźnik na miasto lub NULL;
+ * @param [in] repairYear  – rok ostatniego remontu odcinka drogi.
+ * @return Wartość @p true, jeśli modyfikacja się powiodła, @p false
+ * w przypadkach opisanych w @ref repairRoad.
+ */
+static bool repair_road(Map* map, City* c1, City* c2, int repairYear) {
+    if (!c1 || !c2 || repairYear == 0)
         return false;
 
     if (!areConnected(c1, c2))
@@ -142,148 +676,786 @@ bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear)
     if (road->repairYear > repairYear)
         return false;
 
+    for (route_use* use = road->routes; use; use = use->next)
+        forget_repair(map->routes[use->route_id], road->repairYear);
     changeRepairYear(c1, c2, repairYear);
     changeRepairYear(c2, c1, repairYear);
+    map->graph_epoch++;
+    if (map->snapshot)
+        snapshot_repair_road(map->snapshot, c1, c2, repairYear);
+    update_trees(map, road, false);
 
     return true;
+}
 
+bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear) {
+    if (!valid_city(city1) || !valid_city(city2))
+        return false;
+
+    return repair_road(map, get_city_id(map->city_id, city1),
+                       get_city_id(map->city_id, city2), repairYear);
+}
+
+bool repairRoadById(Map *map, unsigned city1, unsigned city2,
+                    int repairYear) {
+    return repair_road(map, city_by_id(map, city1), city_by_id(map, city2),
+                       repairYear);
+}
+
+/** @brief Znajduje optymalną drogę pomiędzy dwoma miastami.
+ * Odczytuje drogę z drzewa najlepszych dróg, jeżeli mapa je utrzymuje dla
+ * @p c1. W przeciwnym wypadku korzysta z pamięci podręcznej wyników
+ * wyszukiwań i zapamiętuje w niej nowe wyniki, także brak jednoznacznej
+ * drogi.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] c1          – wskaźnik na miasto;
+ * @param [in] c2          – wskaźnik na miasto różne od @p c1.
+ * @return Pierwszy element listy miast drogi lub NULL, jeżeli nie można
+ * jednoznacznie wyznaczyć drogi lub nie udało się zaalokować pamięci.
+ */
+static list* path_between(Map* map, City* c1, City* c2) {
+    path_tree* tree = current_tree(map, c1);
+    if (tree)
+        return path_tree_path(tree, c2);
+
+    path_cache* cache = current_paths(map);
+    path_key key = make_path_key(c1, NULL, c2, NULL);
+    cached_path* hit = cache ? path_cache_find(cache, &key) : NULL;
+
+    if (hit)
+        return hit->found ? cached_path_list(hit) : NULL;
+
+    list* path = new_list(c2);
+    if (!path)
+        return NULL;
+
+    /* Pulę wskazujemy tylko na czas tego wyszukiwania, bo wyszukiwania
+     * wykonywane przez wątki puli nie mogą jej używać. */
+    if (map->workspace->mode == SEARCH_PARALLEL)
+        map->workspace->workers = current_workers(map);
+
+    bool found = find_path(map->workspace, current_snapshot(map),
+                           current_hierarchy(map), current_landmarks(map),
+                           path, NULL, c1, c2, map->n_of_cities);
+    map->workspace->workers = NULL;
+
+    if (!found) {
+        free_list(path);
+        path = NULL;
+    }
+
+    path = first_elem(path);
+    if (cache && !map->workspace->out_of_memory)
+        path_cache_put(cache, &key, path);
+
+    return path;
+}
+
+/** @brief Znajduje optymalny fragment wydłużający drogę krajową.
+ * Działa jak @ref find_extension, korzystając z pamięci podręcznej wyników
+ * wyszukiwań.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] route       – droga krajowa;
+ * @param [in] c           – wskaźnik na miasto.
+ * @return Pierwszy element listy miast fragmentu lub NULL w przypadkach
+ * opisanych w @ref find_extension.
+ */
+static list* extension_to(Map* map, national_route* route, City* c) {
+    path_cache* cache = current_paths(map);
+    path_key key = make_path_key(route_last_city(route),
+                                 route_first_city(route), c, route);
+    cached_path* hit = cache ? path_cache_find(cache, &key) : NULL;
+
+    if (hit)
+        return hit->found ? cached_path_list(hit) : NULL;
+
+    list* extension = find_extension(map->workspace, current_snapshot(map),
+                                     current_landmarks(map), route, c,
+                                     map->n_of_cities);
+
+    if (cache && !map->workspace->out_of_memory)
+        path_cache_put(cache, &key, extension);
+
+    return extension;
+}
+
+/** @brief Łączy dwa różne istniejące miasta drogą krajową.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] routeId     – numer drogi krajowej;
+ * @param [in] c1          – wskaźnik na miasto;
+ * @param [in] c2          – wskaźnik na miasto różne od @p c1.
+ * @return Wartość @p true, jeśli droga krajowa została utworzona, @p false
+ * w przypadkach opisanych w @ref newRoute.
+ */
+static bool new_route(Map* map, unsigned routeId, City* c1, City* c2) {
+    if (routeId >= MAX_ROUTES || map->routes[routeId])
+        return false;
+
+    list* path = path_between(map, c1, c2);
+    if (!path)
+        return false;
+
+    national_route* route = new_national_route(path);
+    if (!route || !index_path(&map->route_uses, routeId, path)) {
+        free_national_route(route);
+        free_list(path);
+        return false;
+    }
+
+    free_list(path);
+    map->routes[routeId] = route;
+
+    return true;
 }
 
 bool newRoute(Map *map, unsigned routeId,
               const char *city1, const char *city2) {
-    if (!valid_newRoute(map, city1, city2))
+    City* c1;
+    City* c2;
+
+    if (!route_endpoints(map, city1, city2, &c1, &c2))
+        return false;
+
+    return new_route(map, routeId, c1, c2);
+}
+
+bool newRouteById(Map *map, unsigned routeId, unsigned city1, unsigned city2) {
+    City* c1 = city_by_id(map, city1);
+    City* c2 = city_by_id(map, city2);
+
+    if (!c1 || !c2 || c1 == c2)
         return false;
 
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
+    return new_route(map, routeId, c1, c2);
+}
 
-    list* route = new_list(c2);
-    if (!route)
+/** @brief Wydłuża drogę krajową do podanego miasta.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] routeId     – numer drogi krajowej;
+ * @param [in] c           – wskaźnik na miasto lub NULL.
+ * @return Wartość @p true, jeśli droga krajowa została wydłużona, @p false
+ * w przypadkach opisanych w @ref extendRoute.
+ */
+static bool extend_route(Map* map, unsigned routeId, City* c) {
+    if (!c || routeId >= MAX_ROUTES || !map->routes[routeId])
         return false;
 
-    if (!find_path(route, map->routes[routeId], c1, c2, map->n_of_cities)) {
-        free_list(route);
+    national_route* route = map->routes[routeId];
+    list* extension = extension_to(map, route, c);
+    if (!extension)
         return false;
+
+    size_t n_of_hops = 0;
+    for (list* l = extension; l->next; l = l->next)
+        n_of_hops++;
+
+    bool ok = reserve_route_uses(&map->route_uses, n_of_hops) &&
+              extend_path(route, extension);
+
+    if (ok)
+        index_path(&map->route_uses, routeId, extension);
+
+    free_list(extension);
+    return ok;
+}
+
+bool extendRoute(Map *map, unsigned routeId, const char *city) {
+    return extend_route(map, routeId, get_city_id(map->city_id, city));
+}
+
+bool extendRouteById(Map *map, unsigned routeId, unsigned city) {
+    return extend_route(map, routeId, city_by_id(map, city));
+}
+
+/** @brief Odłącza odcinek drogi od grafu.
+ * Odcinek pozostaje w pamięci razem z wpisami indeksu dróg krajowych,
+ * które przez niego przechodzą.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] c1          – wskaźnik na miasto;
+ * @param [in] c2          – wskaźnik na miasto połączone z @p c1.
+ * @return Wskaźnik na odłączony odcinek drogi.
+ */
+static Road* detach_road(Map* map, City* c1, City* c2) {
+    Road* road = remove_road(&map->memory, c1, c2);
+
+    map->n_of_roads--;
+    graph_changed(map);
+    if (map->hierarchy && !hierarchy_remove_road(map->hierarchy, c1, c2))
+        drop_hierarchy(map);
+    if (map->landmarks)
+        landmarks_remove_road(map->landmarks);
+    update_trees(map, road, true);
+
+    return road;
+}
+
+/** @brief Przywraca odłączony odcinek drogi.
+ * Dołącza do grafu ten sam odcinek, więc zachowuje on wpisy indeksu dróg
+ * krajowych, a drogi krajowe, które przez niego przechodziły, nadal na
+ * niego wskazują.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in, out] road   – odłączony odcinek drogi.
+ */
+static void restore_road(Map* map, Road* road) {
+    if (!attach_road(&map->memory, road))
+        return;
+
+    if (map->landmarks)
+        landmarks_restore_road(map->landmarks);
+    road_added(map, road);
+}
+
+/** @brief Przywraca odłączone odcinki drogi w odwrotnej kolejności.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in, out] roads  – odłączone odcinki drogi;
+ * @param [in] n           – liczba odcinków.
+ */
+static void restore_roads(Map* map, Road** roads, size_t n) {
+    while (n > 0)
+        restore_road(map, roads[--n]);
+}
+
+/** @brief Typ danych opisujący przerwę w drodze krajowej, uzupełnianą
+ * fragmentem wstawionym pomiędzy jej końce.
+ */
+typedef struct route_gap {
+    unsigned route_id; ///< Numer drogi krajowej
+    size_t hop; ///< Numer usuniętego odcinka na drodze krajowej
+    City* from; ///< Miasto drogi krajowej przed przerwą
+    City* to; ///< Miasto drogi krajowej za przerwą
+    list* path; ///< Pierwszy element listy miast fragmentu lub NULL
+} route_gap;
+
+/** @brief Typ danych opisujący uzupełnianie dróg krajowych przerwanych
+ * przez usunięcie odcinków drogi.
+ * Każda droga krajowa jest uzupełniana przez jedno zadanie, które wstawia
+ * fragmenty w kolejne przerwy jej wersji roboczej, więc następne fragmenty
+ * omijają poprzednie. Zadania tylko czytają graf, a zmieniają jedynie
+ * wersje robocze swoich dróg krajowych, więc mogą być wykonywane
+ * równolegle, każde w pamięci roboczej swojego wątku.
+ */
+typedef struct repair_job {
+    Map* map; ///< Mapa dróg
+    graph_snapshot* g; ///< Aktualna migawka grafu lub NULL
+    landmarks* lm; ///< Aktualne tablice odległości lub NULL
+    unsigned* route_ids; ///< Numery uzupełnianych dróg krajowych
+    size_t* first_gap; ///< Przerwy @p i-tej drogi krajowej zajmują w
+    ///< @p gaps miejsca od @p first_gap[i] do @p first_gap[i + 1] - 1
+    route_gap* gaps; ///< Przerwy w kolejności na drogach krajowych
+    size_t n_of_gaps; ///< Liczba przerw
+    bool* repaired; ///< Czy udało się uzupełnić drogę krajową
+} repair_job;
+
+/** @brief Uzupełnia wszystkie przerwy jednej drogi krajowej w jej wersji
+ * roboczej.
+ * @param [in, out] arg    – wskaźnik na opis uzupełniania;
+ * @param [in] worker      – numer wątku;
+ * @param [in] i           – numer drogi krajowej w opisie uzupełniania.
+ */
+static void repair_route(void* arg, size_t worker, size_t i) {
+    repair_job* job = (repair_job*)arg;
+    Map* map = job->map;
+    national_route* route = map->routes[job->route_ids[i]];
+    route_gap* gap = &job->gaps[job->first_gap[i]];
+    route_gap* end = &job->gaps[job->first_gap[i + 1]];
+    size_t added = 0;
+    bool ok = true;
+
+    /* Numery przerw dotyczą drogi sprzed zmian, więc przesuwamy je
+     * o liczbę miast wstawionych we wcześniejsze przerwy. */
+    start_draft(route);
+    for (; ok && gap < end; gap++) {
+        list* extension = new_list(gap->to);
+
+        ok = extension &&
+             find_path(worker_workspace(map, worker), job->g, NULL, job->lm,
+                       extension, route, gap->from, gap->to,
+                       map->n_of_cities);
+        gap->path = first_elem(extension);
+        ok = ok && fill_gap(route, gap->hop + added, gap->path);
+
+        for (list* l = gap->path; ok && l->next->next; l = l->next)
+            added++;
     }
 
-    map->routes[routeId] = route;
+    job->repaired[i] = ok;
+}
+
+/** @brief Wykonuje niezależne wyszukiwania.
+ * Jeżeli zadań jest więcej niż jedno, a mapa może używać wielu wątków, to
+ * są wykonywane równolegle, każde w pamięci roboczej swojego wątku.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] task        – funkcja wykonująca zadanie;
+ * @param [in, out] arg    – dane przekazywane do @p task;
+ * @param [in] n_of_tasks  – liczba zadań.
+ */
+static void run_searches(Map* map, pool_task task, void* arg,
+                         size_t n_of_tasks) {
+    worker_pool* pool = (n_of_tasks > 1) ? current_workers(map) : NULL;
+
+    if (!pool) {
+        for (size_t i = 0; i < n_of_tasks; i++)
+            task(arg, 0, i);
+        return;
+    }
+
+    for (size_t i = 1; i < worker_count(pool); i++) {
+        worker_workspace(map, i)->mode = map->workspace->mode;
+        worker_workspace(map, i)->max_length = map->workspace->max_length;
+    }
+
+    run_tasks(pool, task, arg, n_of_tasks);
+
+    /* Praca wątków liczy się do kosztu wyszukiwań od zmiany grafu. */
+    for (size_t i = 1; i < worker_count(pool); i++) {
+        map->workspace->work += worker_workspace(map, i)->work;
+        worker_workspace(map, i)->work = 0;
+    }
+}
+
+/** @brief Zatwierdza albo porzuca wersje robocze uzupełnianych dróg
+ * krajowych.
+ * @param [in, out] job    – opis uzupełniania;
+ * @param [in] n_of_routes – liczba uzupełnianych dróg krajowych;
+ * @param [in] commit      – czy wersje robocze mają zastąpić drogi.
+ */
+static void finish_repairs(repair_job* job, size_t n_of_routes,
+                           bool commit) {
+    for (size_t i = 0; i < n_of_routes; i++) {
+        national_route* route = job->map->routes[job->route_ids[i]];
+
+        if (commit)
+            commit_draft(route);
+        else
+            drop_draft(route);
+    }
+}
+
+/** @brief Zwalnia opis uzupełniania razem z listami miast fragmentów.
+ * @param [in, out] job    – opis uzupełniania.
+ */
+static void free_repairs(repair_job* job) {
+    for (size_t k = 0; job->gaps && k < job->n_of_gaps; k++)
+        free_list(job->gaps[k].path);
+
+    free(job->route_ids);
+    free(job->first_gap);
+    free(job->gaps);
+    free(job->repaired);
+}
+
+/** @brief Porównuje przerwy po numerach dróg krajowych, a potem po numerach
+ * odcinków.
+ * @param [in] a           – wskaźnik na przerwę;
+ * @param [in] b           – wskaźnik na przerwę.
+ * @return Liczba ujemna, zero lub dodatnia, jeżeli pierwsza przerwa
+ * jest odpowiednio wcześniej, w tym samym miejscu lub później.
+ */
+static int compare_gaps(const void* a, const void* b) {
+    const route_gap* g1 = (const route_gap*)a;
+    const route_gap* g2 = (const route_gap*)b;
+
+    if (g1->route_id != g2->route_id)
+        return (g1->route_id > g2->route_id) ? 1 : -1;
+
+    return (g1->hop > g2->hop) - (g1->hop < g2->hop);
+}
+
+/** @brief Przygotowuje opis uzupełniania dróg krajowych przechodzących
+ * przez odłączone odcinki.
+ * Miejsce odcinka na drodze krajowej wyznacza z etykiet jego końców.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [out] job        – opis uzupełniania;
+ * @param [in] roads       – odłączone odcinki drogi;
+ * @param [in] n           – liczba odcinków;
+ * @param [in] n_of_gaps   – łączna liczba przejść dróg krajowych przez
+ * odcinki;
+ * @param [out] n_of_routes – liczba dróg krajowych do uzupełnienia.
+ * @return Wartość @p false, jeśli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool plan_repairs(Map* map, repair_job* job, Road** roads, size_t n,
+                         size_t n_of_gaps, size_t* n_of_routes) {
+    job->n_of_gaps = n_of_gaps;
+    job->route_ids = (unsigned*)malloc((n_of_gaps + 1) * sizeof(unsigned));
+    job->first_gap = (size_t*)malloc((n_of_gaps + 2) * sizeof(size_t));
+    job->gaps = (route_gap*)calloc(n_of_gaps + 1, sizeof(route_gap));
+    job->repaired = (bool*)malloc((n_of_gaps + 1) * sizeof(bool));
+    if (!job->route_ids || !job->first_gap || !job->gaps || !job->repaired) {
+        free_repairs(job);
+        return false;
+    }
+
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        Road* road = roads[i];
+
+        for (route_use* use = road->routes; use; use = use->next, k++) {
+            national_route* route = map->routes[use->route_id];
+            size_t i1 = route_position(route, road->city1);
+            size_t i2 = route_position(route, road->city2);
+            route_gap* gap = &job->gaps[k];
+
+            gap->route_id = use->route_id;
+            gap->hop = (i1 < i2) ? i1 : i2;
+            gap->from = (i1 < i2) ? road->city1 : road->city2;
+            gap->to = (i1 < i2) ? road->city2 : road->city1;
+        }
+    }
+
+    /* Przerwy tej samej drogi krajowej trafiają obok siebie, w kolejności
+     * na drodze krajowej. */
+    qsort(job->gaps, n_of_gaps, sizeof(route_gap), compare_gaps);
+
+    *n_of_routes = 0;
+    for (k = 0; k < n_of_gaps; k++) {
+        if (k == 0 || job->gaps[k].route_id != job->gaps[k - 1].route_id) {
+            job->route_ids[*n_of_routes] = job->gaps[k].route_id;
+            job->first_gap[(*n_of_routes)++] = k;
+        }
+    }
+    job->first_gap[*n_of_routes] = n_of_gaps;
 
     return true;
 }
 
-bool extendRoute(Map *map, unsigned routeId, const char *city) {
-    City* c = get_city_id(map->city_id, city);
-    if (!c || !map->routes[routeId])
+/** @brief Przenosi wpisy indeksu z usuniętych odcinków na fragmenty
+ * wstawione w przerwy dróg krajowych.
+ * Pamięć na wpisy musi być wcześniej zarezerwowana.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] job         – opis uzupełniania;
+ * @param [in, out] roads  – usunięte odcinki drogi;
+ * @param [in] n           – liczba odcinków.
+ */
+static void index_repairs(Map* map, repair_job* job, Road** roads,
+                          size_t n) {
+    for (size_t i = 0; i < n; i++)
+        unindex_road(&map->route_uses, roads[i]);
+
+    for (size_t k = 0; k < job->n_of_gaps; k++)
+        index_path(&map->route_uses, job->gaps[k].route_id,
+                   job->gaps[k].path);
+}
+
+/** @brief Porównuje odcinki drogi po adresach.
+ * @param [in] a           – wskaźnik na wskaźnik na odcinek drogi;
+ * @param [in] b           – wskaźnik na wskaźnik na odcinek drogi.
+ * @return Liczba ujemna, zero lub dodatnia, jeżeli adres pierwszego
+ * odcinka jest odpowiednio mniejszy, równy lub większy.
+ */
+static int compare_roads(const void* a, const void* b) {
+    uintptr_t r1 = (uintptr_t)*(Road* const*)a;
+    uintptr_t r2 = (uintptr_t)*(Road* const*)b;
+
+    return (r1 > r2) - (r1 < r2);
+}
+
+/** @brief Znajduje usuwane odcinki drogi.
+ * @param [in] ends        – końce odcinków, miasta mogą mieć wartość NULL;
+ * @param [in] n           – liczba odcinków;
+ * @param [out] roads      – tablica na @p n odcinków;
+ * @param [out] sorted     – tablica na @p n odcinków, używana do szukania
+ * powtórzeń.
+ * @return Wartość @p true, jeśli każda para miast jest połączona odcinkiem
+ * drogi i żaden odcinek się nie powtarza, @p false w przeciwnym wypadku.
+ */
+static bool find_roads(City* ends[][2], size_t n, Road** roads,
+                       Road** sorted) {
+    for (size_t i = 0; i < n; i++) {
+        if (!areConnected(ends[i][0], ends[i][1]))
+            return false;
+
+        roads[i] = sorted[i] = getRoad(ends[i][0], ends[i][1]);
+    }
+
+    qsort(sorted, n, sizeof(Road*), compare_roads);
+    for (size_t i = 1; i < n; i++) {
+        if (sorted[i - 1] == sorted[i])
+            return false;
+    }
+
+    return true;
+}
+
+/** @brief Usuwa naraz odcinki drogi.
+ * Najpierw sprawdza, czy wszystkie odcinki istnieją i się nie powtarzają,
+ * żeby niepoprawne wywołanie niczego w mapie nie przeliczało. Potem
+ * odłącza wszystkie odcinki i uzupełnia wersję roboczą każdej przerwanej
+ * drogi krajowej jeden raz, w grafie bez żadnego z nich.
+ * Wersje robocze zastępują drogi krajowe dopiero, gdy wszystkie zostały
+ * uzupełnione, a w przeciwnym wypadku są porzucane, a odcinki przywracane.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] ends        – końce odcinków, miasta mogą mieć wartość NULL;
+ * @param [in] n           – liczba odcinków.
+ * @return Wartość @p true, jeśli odcinki drogi zostały usunięte, @p false
+ * w przypadkach opisanych w @ref removeRoads.
+ */
+static bool remove_roads(Map* map, City* ends[][2], size_t n) {
+    Road** roads = (Road**)malloc((2 * n + 1) * sizeof(Road*));
+    if (!roads)
         return false;
 
-    list* route_pocz = first_elem(map->routes[routeId]);
-    list* route_kon = last_elem(map->routes[routeId]);
+    if (!find_roads(ends, n, roads, roads + n)) {
+        free(roads);
+        return false;
+    }
 
-    list* extend_kon = new_list(c);
-    list* extend_pocz = new_list(route_pocz->city);
+    size_t n_of_gaps = 0;
+    for (size_t i = 0; i < n; i++) {
+        detach_road(map, ends[i][0], ends[i][1]);
+        for (route_use* use = roads[i]->routes; use; use = use->next)
+            n_of_gaps++;
+    }
 
-    if (!extend_pocz || !extend_kon) {
-        if (extend_kon)
-            free(extend_kon);
-        if(extend_pocz)
-            free(extend_pocz);
+    repair_job job;
+    size_t n_of_routes = 0;
+    if (!plan_repairs(map, &job, roads, n, n_of_gaps, &n_of_routes)) {
+        restore_roads(map, roads, n);
+        free(roads);
         return false;
     }
 
-    find_path(extend_kon, map->routes[routeId],
-              route_kon->city, c, map->n_of_cities);
-    find_path(extend_pocz, map->routes[routeId],
-              c, route_pocz->city, map->n_of_cities);
+    job.map = map;
+    job.g = current_snapshot(map);
+    job.lm = current_landmarks(map);
+    run_searches(map, repair_route, &job, n_of_routes);
 
-    extend_pocz = first_elem(extend_pocz);
-    extend_kon = first_elem(extend_kon);
+    size_t n_of_hops = 0;
+    bool ok = true;
+    for (size_t i = 0; i < n_of_routes; i++)
+        ok = ok && job.repaired[i];
 
-    if (compare_paths(extend_kon, extend_pocz) > 0) {
-        map->routes[routeId] = extend_path(route_pocz, extend_kon);
-        free_list(extend_pocz);
-        return true;
+    for (size_t k = 0; ok && k < n_of_gaps; k++) {
+        for (list* l = job.gaps[k].path; l->next; l = l->next)
+            n_of_hops++;
     }
-    if (compare_paths(extend_kon, extend_pocz) < 0) {
-        map->routes[routeId] = extend_path(extend_pocz, route_pocz);
-        free_list(extend_kon);
-        return true;
+
+    if (!ok || !reserve_route_uses(&map->route_uses, n_of_hops)) {
+        finish_repairs(&job, n_of_routes, false);
+        free_repairs(&job);
+        restore_roads(map, roads, n);
+        free(roads);
+        return false;
     }
 
-    return false;
+    finish_repairs(&job, n_of_routes, true);
+    index_repairs(map, &job, roads, n);
+
+    for (size_t i = 0; i < n; i++)
+        free_road(&map->memory, roads[i]);
+
+    free_repairs(&job);
+    free(roads);
+    return true;
 }
 
 bool removeRoad(Map *map, const char *city1, const char *city2) {
-    City* c1 = get_city_id(map->city_id, city1);
-    City* c2 = get_city_id(map->city_id, city2);
-    if (!areConnected(c1, c2))
+    City* ends[1][2] = {{get_city_id(map->city_id, city1),
+                         get_city_id(map->city_id, city2)}};
+
+    return remove_roads(map, ends, 1);
+}
+
+bool removeRoadById(Map *map, unsigned city1, unsigned city2) {
+    City* ends[1][2] = {{city_by_id(map, city1), city_by_id(map, city2)}};
+
+    return remove_roads(map, ends, 1);
+}
+
+bool removeRoads(Map *map, const char *cities[][2], size_t n) {
+    City* (*ends)[2] = (City* (*)[2])malloc((n + 1) * sizeof(*ends));
+    if (!ends)
         return false;
 
-    list** extensions = (list**)malloc(MAX_ROUTES * sizeof(list));
-    if (!extensions)
+    for (size_t i = 0; i < n; i++) {
+        ends[i][0] = get_city_id(map->city_id, cities[i][0]);
+        ends[i][1] = get_city_id(map->city_id, cities[i][1]);
+    }
+
+    bool removed = remove_roads(map, ends, n);
+
+    free(ends);
+    return removed;
+}
+
+bool removeRoadsById(Map *map, const unsigned cities[][2], size_t n) {
+    City* (*ends)[2] = (City* (*)[2])malloc((n + 1) * sizeof(*ends));
+    if (!ends)
         return false;
 
-    Road* road = remove_road(c1, c2);
-    for (int i = 0; i < MAX_ROUTES; i++)
-        extensions[i] = NULL;
-
-    for (int i = 0; i < MAX_ROUTES; i++) {
-        if (containsRoad(map->routes[i], c1, c2)) {
-            extensions[i] = new_list(c2);
-            if (!extensions[i]) {
-                free_routes(extensions);
-                addRoad(map, c1->city_name, c2->city_name,
-                        road->length, road->repairYear);
-                return false;
-            }
-            if (!find_path(extensions[i], map->routes[i],
-                      c1, c2, map->n_of_cities)) {
-                free_routes(extensions);
-                addRoad(map, c1->city_name, c2->city_name,
-                        road->length, road->repairYear);
-                return false;
-            }
-        }
-        if (containsRoad(map->routes[i], c2, c1)) {
-            extensions[i] = new_list(c1);
-            if (!extensions[i]) {
-                free_routes(extensions);
-                addRoad(map, c1->city_name, c2->city_name,
-                        road->length, road->repairYear);
-                return false;
-            }
-            if (!find_path(extensions[i], map->routes[i],
-                           c2, c1, map->n_of_cities)) {
-                free_routes(extensions);
-                addRoad(map, c1->city_name, c2->city_name,
-                        road->length, road->repairYear);
-                return false;
-            }
-        }
+    for (size_t i = 0; i < n; i++) {
+        ends[i][0] = city_by_id(map, cities[i][0]);
+        ends[i][1] = city_by_id(map, cities[i][1]);
     }
 
-    for (int i = 0; i < MAX_ROUTES; i++) {
-        extensions[i] = first_elem(extensions[i]);
+    bool removed = remove_roads(map, ends, n);
 
-        if ((containsRoad(map->routes[i], c1, c2) ||
-             containsRoad(map->routes[i], c2, c1)) &&
-             !extensions[i])  {
-            free_routes(extensions);
-            addRoad(map, c1->city_name, c2->city_name,
-                    road->length, road->repairYear);
-            return false;
+    free(ends);
+    return removed;
+}
+
+/** @brief Typ danych opisujący zapytanie o najlepsze drogi pomiędzy
+ * miastami.
+ */
+typedef struct query_job {
+    Map* map; ///< Mapa dróg
+    graph_snapshot* g; ///< Aktualna migawka grafu lub NULL
+    City** sources; ///< Miasta początkowe
+    City** targets; ///< Miasta docelowe
+    size_t n_of_targets; ///< Liczba miast docelowych
+    route_info* result; ///< Opisy dróg, wiersz dla każdego miasta
+    ///< początkowego
+    bool* done; ///< Czy udało się opisać drogi z miasta początkowego
+} query_job;
+
+/** @brief Opisuje drogi z jednego miasta początkowego.
+ * Odczytuje je z drzewa najlepszych dróg, jeżeli zostało już zbudowane.
+ * @param [in, out] arg    – wskaźnik na opis zapytania;
+ * @param [in] worker      – numer wątku;
+ * @param [in] i           – numer miasta początkowego.
+ */
+static void query_source(void* arg, size_t worker, size_t i) {
+    query_job* job = (query_job*)arg;
+    hot_city* h = find_hot_city(job->map, job->sources[i]);
+
+    if (h && h->tree) {
+        for (size_t j = 0; j < job->n_of_targets; j++)
+            job->result[i * job->n_of_targets + j] =
+                path_tree_route(h->tree, job->targets[j]);
+
+        job->done[i] = true;
+        return;
+    }
+
+    job->done[i] = search_targets(worker_workspace(job->map, worker), job->g,
+                                  job->sources[i], job->targets,
+                                  job->n_of_targets, job->map->n_of_cities,
+                                  &job->result[i * job->n_of_targets]);
+}
+
+/** @brief Opisuje najlepsze drogi z każdego miasta początkowego do każdego
+ * miasta docelowego.
+ * Wykonuje jedno wyszukiwanie dla każdego miasta początkowego.
+ * @param [in, out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] sources     – miasta początkowe lub NULL, gdy któregoś brak;
+ * @param [in] n_of_sources – liczba miast początkowych;
+ * @param [in] targets     – miasta docelowe lub NULL, gdy któregoś brak;
+ * @param [in] n_of_targets – liczba miast docelowych;
+ * @param [out] result     – tablica opisów dróg.
+ * @return Wartość @p true, jeśli udało się opisać drogi, @p false
+ * w przypadkach opisanych w @ref queryRouteMatrix.
+ */
+static bool query_routes(Map* map, City** sources, size_t n_of_sources,
+                         City** targets, size_t n_of_targets,
+                         route_info* result) {
+    if (!sources || !targets)
+        return false;
+
+    query_job job;
+    job.map = map;
+    job.g = current_snapshot(map);
+    job.sources = sources;
+    job.targets = targets;
+    job.n_of_targets = n_of_targets;
+    job.result = result;
+    job.done = (bool*)malloc((n_of_sources + 1) * sizeof(bool));
+    if (!job.done)
+        return false;
+
+    /* Drzewa budujemy przed rozdzieleniem zadań, bo wątki tylko je czytają. */
+    for (size_t i = 0; i < n_of_sources; i++)
+        current_tree(map, sources[i]);
+
+    run_searches(map, query_source, &job, n_of_sources);
+
+    bool done = true;
+    for (size_t i = 0; i < n_of_sources; i++)
+        done = done && job.done[i];
+
+    free(job.done);
+    return done;
+}
+
+/** @brief Znajduje miasta o podanych nazwach.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] names       – tablica nazw miast;
+ * @param [in] n           – liczba nazw.
+ * @return Tablica miast, którą trzeba zwolnić za pomocą funkcji free, lub
+ * NULL, jeżeli któregoś miasta nie ma albo nie udało się zaalokować
+ * pamięci.
+ */
+static City** cities_by_name(Map* map, const char* names[], size_t n) {
+    City** cities = (City**)malloc((n + 1) * sizeof(City*));
+    if (!cities)
+        return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        cities[i] = get_city_id(map->city_id, names[i]);
+        if (!cities[i]) {
+            free(cities);
+            return NULL;
         }
     }
 
-    for (int i = 0; i < MAX_ROUTES; i++) {
-        if (containsRoad(map->routes[i], c1, c2) ||
-            containsRoad(map->routes[i], c2, c1)) {
-            fill_gap(map->routes[i], extensions[i]);
+    return cities;
+}
+
+/** @brief Znajduje miasta o podanych numerach Id.
+ * @param [in] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param [in] ids         – tablica numerów Id miast;
+ * @param [in] n           – liczba numerów.
+ * @return Tablica miast, którą trzeba zwolnić za pomocą funkcji free, lub
+ * NULL, jeżeli któregoś miasta nie ma albo nie udało się zaalokować
+ * pamięci.
+ */
+static City** cities_by_id(Map* map, const unsigned ids[], size_t n) {
+    City** cities = (City**)malloc((n + 1) * sizeof(City*));
+    if (!cities)
+        return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        cities[i] = city_by_id(map, ids[i]);
+        if (!cities[i]) {
+            free(cities);
+            return NULL;
         }
     }
 
-    free(extensions);
-    free(road);
-    return true;
+    return cities;
+}
+
+bool queryRoutes(Map *map, const char *source, const char *targets[],
+                 size_t n, route_info *result) {
+    return queryRouteMatrix(map, &source, 1, targets, n, result);
+}
+
+bool queryRoutesById(Map *map, unsigned source, const unsigned targets[],
+                     size_t n, route_info *result) {
+    return queryRouteMatrixById(map, &source, 1, targets, n, result);
+}
+
+bool queryRouteMatrix(Map *map, const char *sources[], size_t n_of_sources,
+                      const char *targets[], size_t n_of_targets,
+                      route_info *result) {
+    City** s = cities_by_name(map, sources, n_of_sources);
+    City** t = cities_by_name(map, targets, n_of_targets);
+    bool done = query_routes(map, s, n_of_sources, t, n_of_targets, result);
+
+    free(s);
+    free(t);
+    return done;
+}
+
+bool queryRouteMatrixById(Map *map, const unsigned sources[],
+                          size_t n_of_sources, const unsigned targets[],
+                          size_t n_of_targets, route_info *result) {
+    City** s = cities_by_id(map, sources, n_of_sources);
+    City** t = cities_by_id(map, targets, n_of_targets);
+    bool done = query_routes(map, s, n_of_sources, t, n_of_targets, result);
+
+    free(s);
+    free(t);
+    return done;
 }
 
 char const* getRouteDescription(Map *map, unsigned routeId) {
@@ -303,9 +1475,25 @@ char const* getRouteDescription(Map *map, unsigned routeId) {
 
 void deleteMap(Map *map) {
     for (int i = 0; i < MAX_ROUTES; i++)
-        free_list(map->routes[i]);
-
-    free_cities(map->city_id);
+        free_national_route(map->routes[i]);
+
+    /* Miasta, odcinki i listy odcinków zwalniamy naraz razem z pulami. */
+    for (int i = 0; i < map->n_of_cities; i++)
+        free_city_data(map->cities[i]);
+
+    free_hashtable(map->city_id);
+    release_graph_memory(&map->memory);
+    release_object_pool(&map->route_uses);
+    drop_workers(map);
+    free_search_workspace(map->workspace);
+    free_graph_snapshot(map->snapshot);
+    free_contraction_hierarchy(map->hierarchy);
+    free_landmarks(map->landmarks);
+    free_path_cache(map->paths);
+    for (size_t i = 0; i < map->n_of_hot_cities; i++)
+        free_path_tree(map->hot_cities[i].tree);
+    free(map->hot_cities);
+    free(map->cities);
     free(map);
 }
 
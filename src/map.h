@@ -10,13 +10,21 @@
 #define __MAP_H__
 
 #include <stdbool.h>
+#include <limits.h>
 #include "list.h"
+#include "search_workspace.h"
+#include "graph_operations.h"
 
 /**
  * Struktura przechowująca mapę dróg krajowych.
  */
 typedef struct Map Map;
 
+/**
+ * Wartość zwracana zamiast numeru Id miasta, gdy takiego miasta nie ma.
+ */
+#define NO_CITY UINT_MAX
+
 /** @brief Tworzy nową strukturę.
  * Tworzy nową, pustą strukturę niezawierającą żadnych miast, odcinków dróg ani
  * dróg krajowych.
@@ -32,6 +40,94 @@ Map* newMap(void);
  */
 void deleteMap(Map *map);
 
+/** @brief Zwraca numer Id miasta o podanej nazwie.
+ * Numer Id może zastąpić nazwę miasta w funkcjach z przyrostkiem @p ById,
+ * które nie muszą wtedy ponownie szukać nazwy. Numer Id miasta nie zmienia
+ * się, dopóki istnieje mapa.
+ * @param[in] map        – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city       – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Numer Id miasta lub @ref NO_CITY, jeśli nie ma miasta o podanej
+ * nazwie.
+ */
+unsigned mapLookupCity(Map *map, const char *city);
+
+/** @brief Zwraca numer Id miasta o podanej nazwie, dodając je w razie
+ * potrzeby.
+ * Jeśli miasta o podanej nazwie nie ma w mapie, to dodaje je do mapy bez
+ * żadnych odcinków dróg.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city       – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Numer Id miasta lub @ref NO_CITY, jeśli nazwa jest niepoprawna
+ * lub nie udało się zaalokować pamięci.
+ */
+unsigned mapAddCity(Map *map, const char *city);
+
+/** @brief Ustawia sposób wyszukiwania optymalnych dróg.
+ * Wszystkie sposoby wyszukiwania dają te same wyniki. Domyślnie używane
+ * jest wyszukiwanie od obu końców drogi, @ref SEARCH_BIDIRECTIONAL.
+ * W trybie @ref SEARCH_CONTRACTION mapa utrzymuje hierarchię skrótów,
+ * która przyspiesza tworzenie dróg krajowych w dużych, rzadkich grafach
+ * o małych separatorach, takich jak sieci dróg. Hierarchia jest budowana
+ * przy pierwszym wyszukiwaniu, a @ref addRoad i @ref removeRoad
+ * przeliczają tylko jej część. W grafach bez małych separatorów budowa
+ * jest przerywana po czasie proporcjonalnym do rozmiaru grafu i ponawiana
+ * dopiero po podwojeniu liczby odcinków, a wyszukiwania odbywają się wtedy
+ * od obu końców drogi.
+ * W trybie @ref SEARCH_LANDMARKS wyszukiwanie algorytmem A* jest kierowane
+ * w stronę miasta końcowego przez odległości od miast orientacyjnych.
+ * W trybie @ref SEARCH_PARALLEL jedno wyszukiwanie przy tworzeniu drogi
+ * krajowej jest dzielone pomiędzy wątki ustawione przez
+ * @ref mapSetWorkerCount, co przyspiesza wyszukiwania w bardzo dużych
+ * grafach.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] mode       – sposób wyszukiwania.
+ */
+void mapSetSearchMode(Map *map, search_mode mode);
+
+/** @brief Ustawia liczbę miast orientacyjnych.
+ * W trybie @ref SEARCH_LANDMARKS mapa pamięta odległości od tylu miast
+ * orientacyjnych i używa ich do ograniczania wyszukiwania. Więcej miast
+ * orientacyjnych daje lepsze ograniczenia kosztem pamięci i czasu ich
+ * liczenia. Domyślnie jest ich 8.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] count      – liczba miast orientacyjnych.
+ */
+void mapSetLandmarkCount(Map *map, unsigned count);
+
+/** @brief Ustawia liczbę wątków uzupełniających drogi krajowe.
+ * Gdy usunięcie odcinka drogi przerywa kilka dróg krajowych, fragmenty
+ * uzupełniające je są wyszukiwane równolegle przez tyle wątków. Wynik nie
+ * zależy od liczby wątków. Domyślnie jest ich tyle, ile dostępnych
+ * procesorów, ale nie więcej niż 8. Wartość 0 oznacza jeden wątek.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] count      – liczba wątków.
+ */
+void mapSetWorkerCount(Map *map, unsigned count);
+
+/** @brief Ustawia, czy mapa utrzymuje drzewo najlepszych dróg z miasta.
+ * Dla miasta, z którego zaczyna się wiele dróg krajowych i zapytań, mapa
+ * może pamiętać najlepsze drogi do wszystkich miast. Są one uaktualniane
+ * przy dodawaniu, remontowaniu i usuwaniu odcinków dróg, a tworzenie drogi
+ * krajowej zaczynającej się w tym mieście i zapytania z niego tylko je
+ * odczytują. Drzewo zajmuje pamięć proporcjonalną do liczby miast.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city       – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] hot        – czy mapa ma utrzymywać drzewo.
+ * @return Wartość @p true, jeśli ustawienie się powiodło, @p false, jeśli
+ * miasta nie ma w mapie lub nie udało się zaalokować pamięci.
+ */
+bool mapSetHotCity(Map *map, const char *city, bool hot);
+
+/** @brief Ustawia, czy mapa utrzymuje drzewo najlepszych dróg z miasta.
+ * Działa jak @ref mapSetHotCity, ale miasto podane jest numerem Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city       – numer Id miasta;
+ * @param[in] hot        – czy mapa ma utrzymywać drzewo.
+ * @return Wartość @p true, jeśli ustawienie się powiodło, @p false
+ * w przypadkach opisanych w @ref mapSetHotCity.
+ */
+bool mapSetHotCityById(Map *map, unsigned city, bool hot);
+
 /** @brief Sprawdza, czy nazwa @p city jest poprawną nazwą miasta.
  *
  * @param [in] city     - napis.
@@ -69,6 +165,21 @@ bool valid_addRoad(Map *map, const char *city1, const char *city2,
 bool addRoad(Map *map, const char *city1, const char *city2,
              unsigned length, int builtYear);
 
+/** @brief Dodaje do mapy odcinek drogi między dwoma różnymi miastami.
+ * Działa jak @ref addRoad, ale miasta podane są numerami Id zwróconymi przez
+ * @ref mapLookupCity lub @ref mapAddCity i muszą już istnieć.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – numer Id miasta;
+ * @param[in] city2      – numer Id miasta;
+ * @param[in] length     – długość w km odcinka drogi;
+ * @param[in] builtYear  – rok budowy odcinka drogi.
+ * @return Wartość @p true, jeśli odcinek drogi został dodany.
+ * Wartość @p false w przypadkach opisanych w @ref addRoad lub gdy któreś
+ * z miast nie istnieje.
+ */
+bool addRoadById(Map *map, unsigned city1, unsigned city2,
+                 unsigned length, int builtYear);
+
 /** @brief Modyfikuje rok ostatniego remontu odcinka drogi.
  * Dla odcinka drogi między dwoma miastami zmienia rok jego ostatniego remontu
  * lub ustawia ten rok, jeśli odcinek nie był jeszcze remontowany.
@@ -84,6 +195,18 @@ bool addRoad(Map *map, const char *city1, const char *city2,
  */
 bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear);
 
+/** @brief Modyfikuje rok ostatniego remontu odcinka drogi.
+ * Działa jak @ref repairRoad, ale miasta podane są numerami Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – numer Id miasta;
+ * @param[in] city2      – numer Id miasta;
+ * @param[in] repairYear – rok ostatniego remontu odcinka drogi.
+ * @return Wartość @p true, jeśli modyfikacja się powiodła, @p false
+ * w przypadkach opisanych w @ref repairRoad.
+ */
+bool repairRoadById(Map *map, unsigned city1, unsigned city2,
+                    int repairYear);
+
 /** @brief Sprawdza, czy może powstać droga krajowa pomiędzy dwoma miastami.
  * @param map
  * @param city1
@@ -113,6 +236,17 @@ bool valid_newRoute(Map* map, const char* city1, const char* city2);
 bool newRoute(Map *map, unsigned routeId,
               const char *city1, const char *city2);
 
+/** @brief Łączy dwa różne miasta drogą krajową.
+ * Działa jak @ref newRoute, ale miasta podane są numerami Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] city1      – numer Id miasta;
+ * @param[in] city2      – numer Id miasta.
+ * @return Wartość @p true, jeśli droga krajowa została utworzona, @p false
+ * w przypadkach opisanych w @ref newRoute.
+ */
+bool newRouteById(Map *map, unsigned routeId, unsigned city1, unsigned city2);
+
 /** @brief Wydłuża drogę krajową do podanego miasta.
  * Dodaje do drogi krajowej nowe odcinki dróg do podanego miasta w taki sposób,
  * aby nowy fragment drogi krajowej był najkrótszy. Jeśli jest więcej niż jeden
@@ -132,6 +266,16 @@ bool newRoute(Map *map, unsigned routeId,
  */
 bool extendRoute(Map *map, unsigned routeId, const char *city);
 
+/** @brief Wydłuża drogę krajową do podanego miasta.
+ * Działa jak @ref extendRoute, ale miasto podane jest numerem Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] city       – numer Id miasta.
+ * @return Wartość @p true, jeśli droga krajowa została wydłużona, @p false
+ * w przypadkach opisanych w @ref extendRoute.
+ */
+bool extendRouteById(Map *map, unsigned routeId, unsigned city);
+
 /** @brief Usuwa odcinek drogi między dwoma różnymi miastami.
  * Usuwa odcinek drogi między dwoma miastami. Jeśli usunięcie tego odcinka drogi
  * powoduje przerwanie ciągu jakiejś drogi krajowej, to uzupełnia ją
@@ -151,6 +295,109 @@ bool extendRoute(Map *map, unsigned routeId, const char *city);
  */
 bool removeRoad(Map *map, const char *city1, const char *city2);
 
+/** @brief Usuwa odcinek drogi między dwoma różnymi miastami.
+ * Działa jak @ref removeRoad, ale miasta podane są numerami Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – numer Id miasta;
+ * @param[in] city2      – numer Id miasta.
+ * @return Wartość @p true, jeśli odcinek drogi został usunięty, @p false
+ * w przypadkach opisanych w @ref removeRoad.
+ */
+bool removeRoadById(Map *map, unsigned city1, unsigned city2);
+
+/** @brief Usuwa naraz kilka odcinków drogi.
+ * Najpierw usuwa wszystkie odcinki, a potem uzupełnia każdą przerwaną drogę
+ * krajową tak jak @ref removeRoad, ale w grafie bez żadnego z usuwanych
+ * odcinków i jeden raz. Kolejne przerwy tej samej drogi krajowej są
+ * uzupełniane w kolejności na drodze krajowej, a fragment uzupełniający
+ * przerwę omija fragmenty wstawione wcześniej. Jeżeli nie da się usunąć
+ * któregoś odcinka, to mapa pozostaje bez zmian.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] cities     – tablica par nazw miast, końców odcinków;
+ * @param[in] n          – liczba odcinków.
+ * @return Wartość @p true, jeśli wszystkie odcinki drogi zostały usunięte.
+ * Wartość @p false w przypadkach opisanych w @ref removeRoad, także gdy
+ * ten sam odcinek podano dwa razy.
+ */
+bool removeRoads(Map *map, const char *cities[][2], size_t n);
+
+/** @brief Usuwa naraz kilka odcinków drogi.
+ * Działa jak @ref removeRoads, ale miasta podane są numerami Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] cities     – tablica par numerów Id miast, końców odcinków;
+ * @param[in] n          – liczba odcinków.
+ * @return Wartość @p true, jeśli wszystkie odcinki drogi zostały usunięte,
+ * @p false w przypadkach opisanych w @ref removeRoads.
+ */
+bool removeRoadsById(Map *map, const unsigned cities[][2], size_t n);
+
+/** @brief Opisuje najlepsze drogi z jednego miasta do wielu miast.
+ * Działa jak @ref queryRouteMatrix z jednym miastem początkowym.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] source     – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] targets    – tablica nazw miast docelowych;
+ * @param[in] n          – liczba miast docelowych;
+ * @param[out] result    – tablica na @p n opisów dróg.
+ * @return Wartość @p true, jeśli udało się opisać drogi, @p false
+ * w przypadkach opisanych w @ref queryRouteMatrix.
+ */
+bool queryRoutes(Map *map, const char *source, const char *targets[],
+                 size_t n, route_info *result);
+
+/** @brief Opisuje najlepsze drogi z jednego miasta do wielu miast.
+ * Działa jak @ref queryRoutes, ale miasta podane są numerami Id.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] source     – numer Id miasta;
+ * @param[in] targets    – tablica numerów Id miast docelowych;
+ * @param[in] n          – liczba miast docelowych;
+ * @param[out] result    – tablica na @p n opisów dróg.
+ * @return Wartość @p true, jeśli udało się opisać drogi, @p false
+ * w przypadkach opisanych w @ref queryRouteMatrix.
+ */
+bool queryRoutesById(Map *map, unsigned source, const unsigned targets[],
+                     size_t n, route_info *result);
+
+/** @brief Opisuje najlepsze drogi pomiędzy każdą parą miast.
+ * Dla każdego miasta początkowego i każdego miasta docelowego wyznacza
+ * długość najlepszej drogi, wybieranej tak jak w @ref newRoute, rok budowy
+ * lub ostatniego remontu jej najstarszego odcinka oraz to, czy jest ona
+ * wyznaczona jednoznacznie. Opis drogi z @p i-tego miasta początkowego do
+ * @p j-tego miasta docelowego zapisuje w @p result[i * n_of_targets + j].
+ * Para takich samych miast lub miast niepołączonych żadną drogą ma pole
+ * @p exists równe @p false. Wykonuje jedno wyszukiwanie dla każdego miasta
+ * początkowego, równolegle w wątkach ustawionych przez
+ * @ref mapSetWorkerCount. Nie zmienia dróg krajowych.
+ * @param[in,out] map      – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] sources      – tablica nazw miast początkowych;
+ * @param[in] n_of_sources – liczba miast początkowych;
+ * @param[in] targets      – tablica nazw miast docelowych;
+ * @param[in] n_of_targets – liczba miast docelowych;
+ * @param[out] result      – tablica na @p n_of_sources * @p n_of_targets
+ * opisów dróg.
+ * @return Wartość @p true, jeśli udało się opisać drogi. Wartość @p false,
+ * jeśli któregoś z podanych miast nie ma lub nie udało się zaalokować
+ * pamięci.
+ */
+bool queryRouteMatrix(Map *map, const char *sources[], size_t n_of_sources,
+                      const char *targets[], size_t n_of_targets,
+                      route_info *result);
+
+/** @brief Opisuje najlepsze drogi pomiędzy każdą parą miast.
+ * Działa jak @ref queryRouteMatrix, ale miasta podane są numerami Id.
+ * @param[in,out] map      – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] sources      – tablica numerów Id miast początkowych;
+ * @param[in] n_of_sources – liczba miast początkowych;
+ * @param[in] targets      – tablica numerów Id miast docelowych;
+ * @param[in] n_of_targets – liczba miast docelowych;
+ * @param[out] result      – tablica na @p n_of_sources * @p n_of_targets
+ * opisów dróg.
+ * @return Wartość @p true, jeśli udało się opisać drogi, @p false
+ * w przypadkach opisanych w @ref queryRouteMatrix.
+ */
+bool queryRouteMatrixById(Map *map, const unsigned sources[],
+                          size_t n_of_sources, const unsigned targets[],
+                          size_t n_of_targets, route_info *result);
+
 /** @brief Udostępnia informacje o drodze krajowej.
  * Zwraca wskaźnik na napis, który zawiera informacje o drodze krajowej. Alokuje
  * pamięć na ten napis. Zwraca pusty napis, jeśli nie istnieje droga krajowa
@@ -0,0 +1,508 @@
+#include "national_route.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* Etykiety po ponownym etykietowaniu drogi zaczynają się od LABEL_START,
+ * żeby zostawić miejsce na fragmenty dołączane na początku drogi, i rosną
+ * co LABEL_STEP. */
+#define LABEL_START (1ULL << 62)
+#define LABEL_STEP (1ULL << 32)
+
+void free_national_route(national_route* r) {
+    if (!r)
+        return;
+
+    /* Węzły wszystkich wersji zwalniamy naraz razem z pulą. */
+    release_object_pool(&r->nodes);
+    free(r->slots);
+    free(r->pending);
+    free(r);
+}
+
+/* Liczba elementów listy od podanego do ostatniego. */
+static size_t list_size(list* l) {
+    size_t size = 0;
+
+    for (; l; l = l->next)
+        size++;
+
+    return size;
+}
+
+/* Kolejny losowy priorytet węzła drogi. */
+static unsigned next_priority(national_route* r) {
+    unsigned long long z = (r->seed += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+    return (unsigned)((z ^ (z >> 31)) >> 32);
+}
+
+/* Miejsce, od którego zaczyna się szukanie miasta w tablicy z haszowaniem. */
+static size_t home_slot(national_route* r, City* city) {
+    unsigned long long h = city->city_id * 0x9e3779b97f4a7c15ULL;
+
+    return (size_t)(h ^ (h >> 32)) & (r->n_of_slots - 1);
+}
+
+/* Miejsce miasta w tablicy z haszowaniem albo wolne miejsce, w którym
+ * powinno się znaleźć. */
+static size_t find_slot(national_route* r, City* city) {
+    size_t x = home_slot(r, city);
+
+    while (r->slots[x].city && r->slots[x].city != city)
+        x = (x + 1) & (r->n_of_slots - 1);
+
+    return x;
+}
+
+static void set_label(national_route* r, City* city,
+                      unsigned long long label) {
+    route_slot* slot = &r->slots[find_slot(r, city)];
+
+    slot->city = city;
+    slot->label = label;
+}
+
+static void label_node(void* arg, rope_node* node) {
+    set_label((national_route*)arg, node->city, node->label);
+}
+
+/* Powiększa tablicę z haszowaniem tak, aby była co najmniej dwa razy
+ * większa od podanej liczby miast. */
+static bool reserve_slots(national_route* r, size_t n_of_cities) {
+    size_t n_of_slots = r->n_of_slots ? r->n_of_slots : 8;
+    while (n_of_slots < 2 * n_of_cities)
+        n_of_slots *= 2;
+
+    if (n_of_slots == r->n_of_slots)
+        return true;
+
+    route_slot* slots = (route_slot*)calloc(n_of_slots, sizeof(route_slot));
+    if (!slots)
+        return false;
+
+    route_slot* old = r->slots;
+    size_t n_of_old = r->n_of_slots;
+
+    r->slots = slots;
+    r->n_of_slots = n_of_slots;
+    for (size_t x = 0; x < n_of_old; x++) {
+        if (old[x].city)
+            set_label(r, old[x].city, old[x].label);
+    }
+
+    free(old);
+    return true;
+}
+
+/* Powiększa tablicę miast wstawionych do wersji roboczej tak, aby
+ * zmieściło się w niej jeszcze n miast. */
+static bool reserve_pending(national_route* r, size_t n) {
+    if (r->n_of_pending + n <= r->pending_capacity)
+        return true;
+
+    size_t capacity = 2 * r->pending_capacity;
+    if (capacity < r->n_of_pending + n)
+        capacity = r->n_of_pending + n;
+
+    route_slot* pending = (route_slot*)realloc(r->pending,
+                                               capacity * sizeof(route_slot));
+    if (!pending)
+        return false;
+
+    r->pending = pending;
+    r->pending_capacity = capacity;
+    return true;
+}
+
+/* Uwzględnia nowy odcinek wersji roboczej w roku jej najstarszego
+ * odcinka. */
+static void add_road_repair(national_route* r, Road* road) {
+    if (road && r->draft_repair != 0 && road->repairYear < r->draft_repair)
+        r->draft_repair = road->repairYear;
+}
+
+/* Wybiera etykiety k miast wstawianych pomiędzy węzły before i after,
+ * z których jeden może mieć wartość NULL. Zwraca false, jeżeli etykiety
+ * się tam nie mieszczą. */
+static bool choose_labels(rope_node* before, rope_node* after, size_t k,
+                          unsigned long long* first,
+                          unsigned long long* step) {
+    unsigned long long span = (k + 1) * LABEL_STEP;
+    unsigned long long lo = 0, hi = 0;
+
+    if (!before && !after) {
+        *first = LABEL_START;
+        *step = LABEL_STEP;
+        return true;
+    }
+
+    if (before)
+        lo = before->label;
+    else if (after->label > span)
+        lo = after->label - span;
+
+    if (after)
+        hi = after->label;
+    else if (lo <= ULLONG_MAX - span)
+        hi = lo + span;
+
+    if (hi <= lo || hi - lo <= k)
+        return false;
+
+    *step = (hi - lo) / (k + 1);
+    *first = lo + *step;
+    return true;
+}
+
+/* Wstawia do wersji roboczej k kolejnych miast listy, zaczynając od
+ * elementu from, przed miasto numer at. Sąsiednie elementy listy, jeżeli
+ * istnieją, są miastami wersji roboczej numer at - 1 i at. Najpierw
+ * rezerwuje całą potrzebną pamięć, więc jeżeli jej zabraknie, to wersja
+ * robocza pozostaje bez zmian. */
+static bool insert_cities(national_route* r, size_t at, list* from,
+                          size_t k) {
+    size_t size = rope_size(r->draft);
+    rope_node* before = (at > 0) ? rope_at(r->draft, at - 1) : NULL;
+    rope_node* after = (at < size) ? rope_at(r->draft, at) : NULL;
+    Road* replaced = before ? before->next : NULL;
+    unsigned long long label = 0, step = 0;
+    bool fits = choose_labels(before, after, k, &label, &step);
+
+    if (!reserve_slots(r, rope_size(r->root) + r->n_of_pending + k) ||
+        !reserve_pending(r, k) || !reserve_rope_nodes(&r->nodes, k))
+        return false;
+
+    /* Nowe węzły nie są współdzielone, więc łączenie ich nie kopiuje. */
+    rope_node* fragment = NULL;
+    list* l = from;
+    for (size_t i = 0; i < k; i++, l = l->next) {
+        rope_node* node = new_rope_node(&r->nodes, l->city, label,
+                                        next_priority(r));
+        Road* road = (i > 0) ? getRoad(l->prev->city, l->city) : NULL;
+
+        fragment = merge_ropes(&r->nodes, fragment, node, road);
+        add_road_repair(r, road);
+        r->pending[r->n_of_pending + i].city = l->city;
+        r->pending[r->n_of_pending + i].label = label;
+        label += step;
+    }
+
+    /* Kopie węzłów na ścieżkach podziału i obu złączeń, a przy nowych
+     * etykietach wszystkich węzłów. */
+    size_t copies = 6 * (size_t)rope_height(r->draft) +
+                    3 * (size_t)rope_height(fragment) + 4;
+    if (!fits)
+        copies += size + k;
+
+    if (!reserve_rope_nodes(&r->nodes, copies)) {
+        release_rope(&r->nodes, fragment);
+        return false;
+    }
+
+    Road* join1 = from->prev ? getRoad(from->prev->city, from->city) : NULL;
+    Road* join2 = l ? getRoad(l->prev->city, l->city) : NULL;
+    rope_node* head;
+    rope_node* tail;
+
+    if (replaced && replaced->repairYear == r->draft_repair)
+        r->draft_repair = 0;
+    add_road_repair(r, join1);
+    add_road_repair(r, join2);
+
+    split_rope(&r->nodes, r->draft, at, &head, &tail);
+    head = merge_ropes(&r->nodes, head, fragment, join1);
+    r->draft = merge_ropes(&r->nodes, head, tail, join2);
+    r->n_of_pending += k;
+
+    if (!fits) {
+        label = LABEL_START;
+        r->draft = relabel_rope(&r->nodes, r->draft, &label, LABEL_STEP);
+        r->relabeled = true;
+    }
+
+    return true;
+}
+
+void start_draft(national_route* r) {
+    r->draft = retain_rope(r->root);
+    r->draft_repair = r->oldest_repair;
+    r->n_of_pending = 0;
+    r->relabeled = false;
+}
+
+void commit_draft(national_route* r) {
+    if (!r->draft)
+        return;
+
+    release_rope(&r->nodes, r->root);
+    r->root = r->draft;
+    r->draft = NULL;
+    r->oldest_repair = r->draft_repair;
+
+    if (r->relabeled) {
+        memset(r->slots, 0, r->n_of_slots * sizeof(route_slot));
+        walk_rope(r->root, label_node, r);
+    }
+    else {
+        for (size_t i = 0; i < r->n_of_pending; i++)
+            set_label(r, r->pending[i].city, r->pending[i].label);
+    }
+
+    r->n_of_pending = 0;
+    r->relabeled = false;
+}
+
+void drop_draft(national_route* r) {
+    release_rope(&r->nodes, r->draft);
+    r->draft = NULL;
+    r->n_of_pending = 0;
+    r->relabeled = false;
+}
+
+national_route* new_national_route(list* path) {
+    national_route* r = (national_route*)malloc(sizeof(national_route));
+    if (!r)
+        return NULL;
+
+    init_rope_nodes(&r->nodes);
+    r->root = NULL;
+    r->slots = NULL;
+    r->n_of_slots = 0;
+    r->pending = NULL;
+    r->n_of_pending = 0;
+    r->pending_capacity = 0;
+    r->oldest_repair = INT_MAX;
+    r->seed = 0;
+
+    start_draft(r);
+    if (!insert_cities(r, 0, path, list_size(path))) {
+        free_national_route(r);
+        return NULL;
+    }
+
+    commit_draft(r);
+    return r;
+}
+
+City* route_first_city(national_route* r) {
+    return rope_first(r->root)->city;
+}
+
+City* route_last_city(national_route* r) {
+    return rope_last(r->root)->city;
+}
+
+size_t route_size(national_route* r) {
+    return rope_size(r->root);
+}
+
+bool route_contains(national_route* r, City* city) {
+    return r->slots[find_slot(r, city)].city == city;
+}
+
+size_t route_position(national_route* r, City* city) {
+    size_t position;
+
+    find_label(r->root, r->slots[find_slot(r, city)].label, &position);
+    return position;
+}
+
+bool containsRoad(national_route* r, City* city1, City* city2) {
+    if (!route_contains(r, city1))
+        return false;
+
+    size_t position;
+    Road* next = find_label(r->root, r->slots[find_slot(r, city1)].label,
+                            &position)->next;
+
+    return next && (next->city1 == city2 || next->city2 == city2);
+}
+
+unsigned route_length(national_route* r) {
+    return (unsigned)r->root->length;
+}
+
+static void oldest_repair(void* arg, rope_node* node) {
+    int* oldest = (int*)arg;
+
+    if (node->next && node->next->repairYear < *oldest)
+        *oldest = node->next->repairYear;
+}
+
+int route_repair(national_route* r) {
+    if (r->oldest_repair == 0) {
+        r->oldest_repair = INT_MAX;
+        walk_rope(r->root, oldest_repair, &r->oldest_repair);
+    }
+
+    return r->oldest_repair;
+}
+
+int compare_paths(national_route* r1, national_route* r2) {
+    unsigned length1 = route_length(r1), length2 = route_length(r2);
+
+    if (length1 != length2)
+        return (length1 < length2) ? 1 : -1;
+
+    return route_repair(r1) - route_repair(r2);
+}
+
+void forget_repair(national_route* r, int repairYear) {
+    if (repairYear == r->oldest_repair)
+        r->oldest_repair = 0;
+}
+
+void route_walk(national_route* r, route_visitor visit, void* arg) {
+    /* Tablica z haszowaniem leży w pamięci w jednym kawałku, więc jej
+     * przejrzenie jest szybsze niż przejście po drzewie. Wersja robocza
+     * tylko dodaje miasta do drogi. */
+    for (size_t x = 0; x < r->n_of_slots; x++) {
+        if (r->slots[x].city)
+            visit(arg, r->slots[x].city);
+    }
+
+    for (size_t i = 0; r->draft && i < r->n_of_pending; i++)
+        visit(arg, r->pending[i].city);
+}
+
+bool extend_path(national_route* r, list* extension) {
+    size_t n_of_hops = list_size(extension) - 1;
+    bool ok;
+
+    /* Wspólne miasto drogi i fragmentu już jest na drodze. */
+    start_draft(r);
+    if (extension->city == route_last_city(r))
+        ok = insert_cities(r, route_size(r), extension->next, n_of_hops);
+    else
+        ok = insert_cities(r, 0, extension, n_of_hops);
+
+    if (ok)
+        commit_draft(r);
+    else
+        drop_draft(r);
+
+    return ok;
+}
+
+bool fill_gap(national_route* r, size_t hop, list* l) {
+    return insert_cities(r, hop + 1, l->next, list_size(l) - 2);
+}
+
+/** @brief Dodaje napis na podane miejsce do tablicy.
+ * Wstawia napis @p string w napis @p description w taki sposób, że słowo
+ * @p string zaczyna się w słowie @ description na indeksie @p index.
+ * @param [in, out] description   - wskaźnik na tworzący się
+ * napis opisu drogi krajowej;
+ * @param [in] string             - wskaźnik na niepusty napis.
+ * @param [in] index              - wskaźnik na liczbę całkowitą
+ * z zakresu @p description.
+ */
+static void add_at_index(char* description, const char* string,
+                         size_t *index) {
+    size_t pom = *index;
+    for (; string[*index - pom]; (*index)++)
+        description[*index] = string[*index - pom];
+}
+
+/** @brief Dopisuje liczbę i średnik do tworzącego się opisu drogi krajowej.
+ * @param [in, out] description   - wskaźnik na tworzący się
+ * napis opisu drogi krajowej;
+ * @param [in] d                  - liczba całkowita;
+ * @param [in, out] index         - wskaźnik na indeks, od którego wpisywana
+ * jest liczba; zostaje przesunięty za średnik.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, @p true
+ * w przeciwnym wypadku.
+ */
+static bool add_number_at_index(char* description, int d, size_t *index) {
+    char* number = int_to_string(d);
+    if (!number)
+        return false;
+
+    add_at_index(description, number, index);
+    description[(*index)++] = ';';
+    free(number);
+
+    return true;
+}
+
+/** @brief Dopisuje nazwę miasta do tworzącego się opisu drogi krajowej.
+ * @param [in, out] description   - wskaźnik na tworzący się
+ * napis opisu drogi krajowej;
+ * @param [in] city               - wskaźnik na strukturę reprezentującą miasto;
+ * @param [in, out] index         - wskaźnik na indeks, od którego wpisywana
+ * jest nazwa; zostaje przesunięty za nią.
+ */
+static void add_name_at_index(char* description, City* city, size_t *index) {
+    memcpy(description + *index, city->city_name, city->name_length);
+    *index += city->name_length;
+}
+
+/** @brief Typ danych opisujący tworzący się opis drogi krajowej.
+ */
+typedef struct route_description {
+    char* description; ///< Tworzący się napis lub NULL przy liczeniu znaków
+    size_t index; ///< Liczba znaków opisu lub indeks pierwszego wolnego
+    ///< znaku napisu
+    bool ok; ///< Czy udało się zaalokować pamięć
+} route_description;
+
+/** @brief Dolicza do opisu drogi krajowej znaki miasta i następnego odcinka.
+ * @param [in, out] arg     - wskaźnik na tworzący się opis;
+ * @param [in] node         - węzeł miasta drogi.
+ */
+static void count_city(void* arg, rope_node* node) {
+    route_description* d = (route_description*)arg;
+
+    d->index += node->city->name_length;
+    if (node->next) {
+        d->index += int_length(node->next->length) + 1;
+        d->index += int_length(node->next->repairYear) + 1;
+        d->index++;
+    }
+}
+
+/** @brief Dopisuje do opisu drogi krajowej miasto i następny odcinek.
+ * @param [in, out] arg     - wskaźnik na tworzący się opis;
+ * @param [in] node         - węzeł miasta drogi.
+ */
+static void describe_city(void* arg, rope_node* node) {
+    route_description* d = (route_description*)arg;
+
+    add_name_at_index(d->description, node->city, &d->index);
+    if (d->ok && node->next) {
+        d->description[d->index++] = ';';
+        d->ok = add_number_at_index(d->description, node->next->length,
+                                    &d->index) &&
+                add_number_at_index(d->description, node->next->repairYear,
+                                    &d->index);
+    }
+}
+
+char* describeRoute(national_route* r, unsigned routeId) {
+    route_description d = {NULL, 0, true};
+
+    walk_rope(r->root, count_city, &d);
+
+    size_t length = d.index + 1 + int_length(routeId) + 1;
+
+    d.description = (char*)malloc(length * sizeof(char));
+    if (!d.description)
+        return NULL;
+
+    d.description[length - 1] = '\0';
+    d.index = 0;
+    d.ok = add_number_at_index(d.description, routeId, &d.index);
+    if (d.ok)
+        walk_rope(r->root, describe_city, &d);
+
+    if (!d.ok) {
+        free(d.description);
+        return NULL;
+    }
+
+    return d.description;
+}
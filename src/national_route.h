@@ -0,0 +1,220 @@
+/** @file
+ * Biblioteka definiująca drogi krajowe przechowywane jako trwałe ciągi
+ * miast, z wersją roboczą, którą można zatwierdzić albo porzucić.
+ */
+
+#ifndef DROGI_NATIONAL_ROUTE_H
+#define DROGI_NATIONAL_ROUTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "list.h"
+#include "object_pool.h"
+#include "route_rope.h"
+
+/** @brief Typ danych opisujący miejsce w tablicy z haszowaniem miast drogi.
+ */
+typedef struct route_slot {
+    City* city; ///< Miasto drogi lub NULL, jeżeli miejsce jest wolne
+    unsigned long long label; ///< Etykieta miasta
+} route_slot;
+
+/** @brief Typ funkcji odwiedzającej miasta drogi krajowej.
+ * @param [in, out] arg     - Dane przekazane do @ref route_walk;
+ * @param [in] city         - Odwiedzane miasto.
+ */
+typedef void (*route_visitor)(void* arg, City* city);
+
+/** @brief Typ danych reprezentujący drogę krajową.
+ * Miasta drogi tworzą trwały ciąg, w którym każde miasto pamięta odcinek
+ * do następnego, więc długości i lata remontów są czytane z grafu,
+ * a łączna długość drogi jest sumą zapamiętaną w korzeniu. Rok
+ * najstarszego odcinka jest wyznaczany ponownie dopiero wtedy, gdy jest
+ * potrzebny, a odcinek z tego roku zmienił się lub zniknął.
+ * Zmiany drogi są wykonywane na wersji roboczej, która współdzieli
+ * niezmienione węzły z drogą, więc rozpoczęcie, zatwierdzenie
+ * i porzucenie wersji roboczej nie kopiują miast, a wstawienie fragmentu
+ * kopiuje tylko węzły na kilku ścieżkach drzewa.
+ * Miasta mają etykiety rosnące wzdłuż drogi, więc wstawienie fragmentu
+ * nie zmienia etykiet pozostałych miast. Tablica z haszowaniem otwartym
+ * przypisuje miastom zatwierdzonej drogi ich etykiety.
+ */
+typedef struct national_route {
+    rope_node* root; ///< Korzeń ciągu miast drogi
+    rope_node* draft; ///< Korzeń wersji roboczej lub NULL
+    object_pool nodes; ///< Pula węzłów wszystkich wersji drogi
+    route_slot* slots; ///< Tablica z haszowaniem miast drogi
+    size_t n_of_slots; ///< Rozmiar tablicy @p slots, potęga dwójki
+    ///< co najmniej dwa razy większa od liczby miast obu wersji
+    route_slot* pending; ///< Miasta wstawione do wersji roboczej
+    size_t n_of_pending; ///< Liczba miast w tablicy @p pending
+    size_t pending_capacity; ///< Rozmiar tablicy @p pending
+    bool relabeled; ///< Czy wersja robocza dostała nowe etykiety wszystkich
+    ///< miast
+    int oldest_repair; ///< Rok najstarszego odcinka drogi lub 0, jeżeli
+    ///< trzeba go wyznaczyć ponownie
+    int draft_repair; ///< Rok najstarszego odcinka wersji roboczej lub 0
+    unsigned long long seed; ///< Stan generatora priorytetów węzłów
+} national_route;
+
+/** @brief Tworzy drogę krajową z listy miast.
+ * Odcinki pomiędzy miastami odczytuje z grafu.
+ * @param [in] path         - Wskaźnik na pierwszy element listy zawierającej
+ * co najmniej dwa miasta, kolejno połączone odcinkami drogi.
+ * @return Zwraca wskaźnik na utworzoną drogę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+national_route* new_national_route(list* path);
+
+/** @brief Usuwa drogę krajową razem z jej wersją roboczą.
+ * Nie zmienia indeksu dróg krajowych. Nic nie robi, jeżeli @p r ma
+ * wartość NULL.
+ * @param [in, out] r       - Wskaźnik na drogę krajową.
+ */
+void free_national_route(national_route* r);
+
+/** @brief Zwraca pierwsze miasto drogi krajowej.
+ * @param [in] r            - Wskaźnik na drogę krajową.
+ * @return Wskaźnik na pierwsze miasto drogi.
+ */
+City* route_first_city(national_route* r);
+
+/** @brief Zwraca ostatnie miasto drogi krajowej.
+ * @param [in] r            - Wskaźnik na drogę krajową.
+ * @return Wskaźnik na ostatnie miasto drogi.
+ */
+City* route_last_city(national_route* r);
+
+/** @brief Zwraca liczbę miast drogi krajowej.
+ * @param [in] r            - Wskaźnik na drogę krajową.
+ * @return Liczba miast drogi.
+ */
+size_t route_size(national_route* r);
+
+/** @brief Sprawdza, czy droga krajowa przechodzi przez miasto.
+ * Działa w oczekiwanym czasie stałym.
+ * @param [in] r            - Wskaźnik na drogę krajową;
+ * @param [in] city         - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca @p true, jeżeli @p city leży na drodze, @p false
+ * w przeciwnym wypadku.
+ */
+bool route_contains(national_route* r, City* city);
+
+/** @brief Znajduje pozycję miasta na drodze krajowej.
+ * Schodzi w drzewie drogi według etykiety miasta.
+ * @param [in] r            - Wskaźnik na drogę krajową;
+ * @param [in] city         - Wskaźnik na miasto leżące na drodze.
+ * @return Numer miasta na drodze, licząc od zera.
+ */
+size_t route_position(national_route* r, City* city);
+
+/** @brief Sprawdza czy droga zawiera odcinek drogi.
+ * @param [in] r            - Wskaźnik na drogę krajową;
+ * @param [in] city1        - Wskaźnik na strukturę reprezentującą miasto;
+ * @param [in] city2        - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca @p true, jeżeli droga przechodzi z @p city1 bezpośrednio
+ * do @p city2, @p false w przeciwnym wypadku.
+ * Miasto @p city1 jest wyszukiwane tak jak w @ref route_position.
+ */
+bool containsRoad(national_route* r, City* city1, City* city2);
+
+/** @brief Zwraca długość drogi krajowej w czasie stałym.
+ * @param [in] r            - Wskaźnik na drogę krajową.
+ * @return Suma długości odcinków drogi.
+ */
+unsigned route_length(national_route* r);
+
+/** @brief Znajduje najstarszy odcinek drogi krajowej.
+ * Przegląda odcinki tylko wtedy, gdy zapamiętany rok jest nieaktualny.
+ * @param [in, out] r       - Wskaźnik na drogę krajową.
+ * @return Rok budowy lub ostatniego remontu najstarszego odcinka drogi.
+ */
+int route_repair(national_route* r);
+
+/** @brief Porównuje dwie drogi krajowe.
+ * @param [in, out] r1      - Wskaźnik na drogę krajową;
+ * @param [in, out] r2      - Wskaźnik na drogę krajową.
+ * @return Zwraca @p 0 jeżeli drogi są tej samej długości i najstarszy
+ * odcinek jest w obu równie stary. Zwraca liczbę dodatnią, jeżeli pierwsza
+ * droga jest krótsza od drugiej lub, w przypadku równych długości,
+ * najstarszy odcinek pierwszej drogi jest młodszy od najstarszego odcinka
+ * drugiej drogi. Zwraca liczbę ujemną w przeciwnym wypadku.
+ */
+int compare_paths(national_route* r1, national_route* r2);
+
+/** @brief Zapisuje remont odcinka drogi krajowej.
+ * Wywoływana przed zmianą roku remontu odcinka leżącego na drodze.
+ * @param [in, out] r       - Wskaźnik na drogę krajową;
+ * @param [in] repairYear   - Dotychczasowy rok remontu odcinka.
+ */
+void forget_repair(national_route* r, int repairYear);
+
+/** @brief Odwiedza miasta drogi krajowej w dowolnej kolejności.
+ * Jeżeli droga ma wersję roboczą, to odwiedza jej miasta.
+ * @param [in] r            - Wskaźnik na drogę krajową;
+ * @param [in] visit        - Funkcja wywoływana dla kolejnych miast;
+ * @param [in, out] arg     - Dane przekazywane do @p visit.
+ */
+void route_walk(national_route* r, route_visitor visit, void* arg);
+
+/** @brief Rozpoczyna wersję roboczą drogi krajowej.
+ * Wersja robocza jest początkowo równa drodze i współdzieli z nią
+ * wszystkie węzły.
+ * @param [in, out] r       - Wskaźnik na drogę krajową bez wersji roboczej.
+ */
+void start_draft(national_route* r);
+
+/** @brief Zastępuje drogę krajową jej wersją roboczą.
+ * Nie alokuje pamięci. Nic nie robi, jeżeli droga nie ma wersji roboczej.
+ * @param [in, out] r       - Wskaźnik na drogę krajową.
+ */
+void commit_draft(national_route* r);
+
+/** @brief Porzuca wersję roboczą drogi krajowej.
+ * Droga pozostaje bez zmian. Nic nie robi, jeżeli droga nie ma wersji
+ * roboczej.
+ * @param [in, out] r       - Wskaźnik na drogę krajową.
+ */
+void drop_draft(national_route* r);
+
+/** @brief Wydłuża drogę krajową o fragment.
+ * Fragment zaczyna się w ostatnim mieście drogi albo kończy w pierwszym.
+ * Droga nie może mieć wersji roboczej.
+ * @param [in, out] r       - Wskaźnik na drogę krajową;
+ * @param [in] extension    - Wskaźnik na pierwszy element listy miast
+ * fragmentu.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, a droga
+ * pozostała bez zmian, @p true w przeciwnym wypadku.
+ */
+bool extend_path(national_route* r, list* extension);
+
+/** @brief Uzupełnia przerwę w wersji roboczej drogi krajowej fragmentem.
+ * Zastępuje odcinek @p hop odcinkami fragmentu łączącego jego końce.
+ * Kopiuje tylko węzły na ścieżkach prowadzących do miejsca wstawienia.
+ * @param [in, out] r       - Wskaźnik na drogę krajową z wersją roboczą;
+ * @param [in] hop          - Numer zastępowanego odcinka w wersji roboczej;
+ * @param [in] l            - Wskaźnik na pierwszy element listy miast
+ * fragmentu, od miasta @p hop do miasta @p hop + 1 wersji roboczej.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, a wersja
+ * robocza pozostała bez zmian, @p true w przeciwnym wypadku.
+ */
+bool fill_gap(national_route* r, size_t hop, list* l);
+
+/** @brief Zwraca wskaźnik na napis opisujący drogę krajową.
+ *
+ * Zwraca wskaźnik na napis, który zawiera informacje o drodze krajowej. Alokuje
+ * pamięć na ten napis. Informacje są podawane w tej samej kolejności, co miasta
+ * w route.
+ * Informacje wypisywane są w formacie:
+ * numer drogi krajowej;nazwa miasta;długość odcinka drogi;rok budowy lub
+ * ostatniego remontu;nazwa miasta;długość odcinka drogi;rok budowy lub
+ * ostatniego remontu;nazwa miasta;…;nazwa miasta.
+ * @param [in] r       - Wskaźnik na drogę krajową;
+ * @param [in] routeId - nieujemna liczba reprezentująca numer drogi krajowej.
+ * @return Zwraca wskaźnik na napis opisujący drogę krajową lub NULL, gdy
+ * nie udało się zaalokować pamięci.
+ */
+char* describeRoute(national_route* r, unsigned routeId);
+
+#endif //DROGI_NATIONAL_ROUTE_H
@@ -0,0 +1,69 @@
+#include "object_pool.h"
+#include <stdlib.h>
+
+#define FIRST_SLAB_CAPACITY 64
+#define MAX_SLAB_CAPACITY 65536
+
+/** @brief Blok pamięci, z którego wydzielane są obiekty.
+ */
+struct slab {
+    struct slab* next; ///< Następny blok na liście bloków puli
+    max_align_t data[]; ///< Miejsce na obiekty
+};
+
+void init_object_pool(object_pool* pool, size_t object_size) {
+    size_t word = sizeof(void*);
+
+    pool->object_size = (object_size + word - 1) / word * word;
+    pool->slab_capacity = FIRST_SLAB_CAPACITY;
+    pool->slabs = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->free_objects = NULL;
+}
+
+void* pool_alloc(object_pool* pool) {
+    if (pool->free_objects) {
+        void* object = pool->free_objects;
+        pool->free_objects = *(void**)object;
+        return object;
+    }
+
+    if (pool->next == pool->end) {
+        size_t size = pool->slab_capacity * pool->object_size;
+        struct slab* s = (struct slab*)malloc(sizeof(struct slab) + size);
+        if (!s)
+            return NULL;
+
+        s->next = pool->slabs;
+        pool->slabs = s;
+        pool->next = (char*)s->data;
+        pool->end = pool->next + size;
+
+        if (pool->slab_capacity < MAX_SLAB_CAPACITY)
+            pool->slab_capacity *= 2;
+    }
+
+    void* object = pool->next;
+    pool->next += pool->object_size;
+
+    return object;
+}
+
+void pool_free(object_pool* pool, void* object) {
+    if (!object)
+        return;
+
+    *(void**)object = pool->free_objects;
+    pool->free_objects = object;
+}
+
+void release_object_pool(object_pool* pool) {
+    while (pool->slabs) {
+        struct slab* s = pool->slabs;
+        pool->slabs = s->next;
+        free(s);
+    }
+
+    init_object_pool(pool, pool->object_size);
+}
@@ -0,0 +1,55 @@
+/** @file
+ * Biblioteka implementująca pulę obiektów jednakowego rozmiaru,
+ * przydzielanych z dużych bloków pamięci.
+ */
+
+#ifndef DROGI_OBJECT_POOL_H
+#define DROGI_OBJECT_POOL_H
+
+#include <stddef.h>
+
+struct slab;
+
+/** @brief Typ danych reprezentujący pulę obiektów.
+ * Obiekty są wydzielane kolejno z bloków, których rozmiar rośnie
+ * geometrycznie. Zwolnione obiekty trafiają na listę wolnych obiektów
+ * i są używane ponownie przed sięgnięciem do nowego bloku. Wszystkie bloki
+ * zwalniane są naraz przez @ref release_object_pool.
+ */
+typedef struct object_pool {
+    size_t object_size; ///< Rozmiar obiektu zaokrąglony do rozmiaru wskaźnika
+    size_t slab_capacity; ///< Liczba obiektów w następnym bloku
+    struct slab* slabs; ///< Lista zaalokowanych bloków
+    char* next; ///< Pierwsze nieużyte miejsce w bieżącym bloku
+    char* end; ///< Koniec bieżącego bloku
+    void* free_objects; ///< Lista zwolnionych obiektów
+} object_pool;
+
+/** @brief Inicjalizuje pustą pulę obiektów.
+ * @param [out] pool        - Wskaźnik na pulę;
+ * @param [in] object_size  - Rozmiar obiektu w bajtach.
+ */
+void init_object_pool(object_pool* pool, size_t object_size);
+
+/** @brief Przydziela obiekt z puli.
+ * @param [in, out] pool    - Wskaźnik na pulę.
+ * @return Wskaźnik na niezainicjalizowany obiekt lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+void* pool_alloc(object_pool* pool);
+
+/** @brief Oddaje obiekt do puli.
+ * Nic nie robi, jeżeli @p object ma wartość NULL.
+ * @param [in, out] pool    - Wskaźnik na pulę, z której pochodzi obiekt;
+ * @param [in] object       - Wskaźnik na obiekt.
+ */
+void pool_free(object_pool* pool, void* object);
+
+/** @brief Zwalnia całą pamięć puli.
+ * Wszystkie obiekty przydzielone z puli przestają być ważne, a pula
+ * wraca do stanu pustego.
+ * @param [in, out] pool    - Wskaźnik na pulę.
+ */
+void release_object_pool(object_pool* pool);
+
+#endif //DROGI_OBJECT_POOL_H
@@ -0,0 +1,237 @@
+#include "path_cache.h"
+#include <stdlib.h>
+#include <limits.h>
+
+/* Miesza bity numeru, żeby sumy skrótów różnych zbiorów rzadko były
+ * równe. */
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+
+    return x;
+}
+
+static bool same_key(const path_key* k1, const path_key* k2) {
+    return k1->from == k2->from && k1->from2 == k2->from2 &&
+           k1->to == k2->to && k1->n_of_excluded == k2->n_of_excluded &&
+           k1->sum == k2->sum && k1->xor_sum == k2->xor_sum;
+}
+
+static size_t bucket_of(const path_cache* cache, const path_key* key) {
+    uint64_t h = mix(key->from->city_id) ^
+                 mix(((uint64_t)key->to->city_id << 32) +
+                     (key->from2 ? key->from2->city_id + 1 : 0)) ^
+                 key->sum;
+
+    return (size_t)(mix(h) & (cache->n_of_buckets - 1));
+}
+
+path_cache* new_path_cache(size_t capacity) {
+    path_cache* cache = (path_cache*)malloc(sizeof(path_cache));
+    if (!cache)
+        return NULL;
+
+    cache->n_of_buckets = 1;
+    while (cache->n_of_buckets < 2 * capacity)
+        cache->n_of_buckets *= 2;
+
+    cache->capacity = capacity;
+    cache->paths = (cached_path*)malloc(capacity * sizeof(cached_path));
+    cache->buckets = (size_t*)malloc(cache->n_of_buckets * sizeof(size_t));
+    if (!cache->paths || !cache->buckets) {
+        free(cache->paths);
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+
+    cache->size = 0;
+    cache->epoch = 0;
+    cache->newest = cache->oldest = NO_PATH;
+    for (size_t i = 0; i < cache->n_of_buckets; i++)
+        cache->buckets[i] = NO_PATH;
+
+    return cache;
+}
+
+void free_path_cache(path_cache* cache) {
+    if (!cache)
+        return;
+
+    for (size_t i = 0; i < cache->size; i++)
+        free(cache->paths[i].cities);
+
+    free(cache->paths);
+    free(cache->buckets);
+    free(cache);
+}
+
+void path_cache_sync(path_cache* cache, unsigned long epoch) {
+    if (cache->epoch == epoch)
+        return;
+
+    for (size_t i = 0; i < cache->size; i++)
+        free(cache->paths[i].cities);
+    for (size_t i = 0; i < cache->n_of_buckets; i++)
+        cache->buckets[i] = NO_PATH;
+
+    cache->size = 0;
+    cache->newest = cache->oldest = NO_PATH;
+    cache->epoch = epoch;
+}
+
+/* Dopisuje wykluczone miasto do klucza wyszukiwania. */
+static void add_excluded(void* arg, City* city) {
+    path_key* key = (path_key*)arg;
+    unsigned id = city->city_id;
+
+    key->n_of_excluded++;
+    key->sum += mix(id);
+    key->xor_sum ^= mix(id ^ UINT64_C(0x9e3779b97f4a7c15));
+}
+
+path_key make_path_key(City* from, City* from2, City* to,
+                       national_route* excluded) {
+    path_key key;
+
+    key.from = from;
+    key.from2 = from2;
+    key.to = to;
+    key.n_of_excluded = 0;
+    key.sum = key.xor_sum = 0;
+
+    if (excluded)
+        route_walk(excluded, add_excluded, &key);
+
+    return key;
+}
+
+/* Wyjmuje wynik z listy wyników uporządkowanej według czasu użycia. */
+static void unlink_lru(path_cache* cache, size_t x) {
+    cached_path* p = &cache->paths[x];
+
+    if (p->newer != NO_PATH)
+        cache->paths[p->newer].older = p->older;
+    else
+        cache->newest = p->older;
+
+    if (p->older != NO_PATH)
+        cache->paths[p->older].newer = p->newer;
+    else
+        cache->oldest = p->newer;
+}
+
+/* Wstawia wynik na początek listy jako ostatnio użyty. */
+static void push_lru(path_cache* cache, size_t x) {
+    cached_path* p = &cache->paths[x];
+
+    p->newer = NO_PATH;
+    p->older = cache->newest;
+    if (cache->newest != NO_PATH)
+        cache->paths[cache->newest].newer = x;
+    else
+        cache->oldest = x;
+
+    cache->newest = x;
+}
+
+/* Wyjmuje wynik z listy wyników jego kubełka. */
+static void unlink_bucket(path_cache* cache, size_t x) {
+    size_t* link = &cache->buckets[bucket_of(cache, &cache->paths[x].key)];
+
+    while (*link != x)
+        link = &cache->paths[*link].next;
+
+    *link = cache->paths[x].next;
+}
+
+cached_path* path_cache_find(path_cache* cache, const path_key* key) {
+    size_t x = cache->buckets[bucket_of(cache, key)];
+
+    while (x != NO_PATH && !same_key(&cache->paths[x].key, key))
+        x = cache->paths[x].next;
+
+    if (x == NO_PATH)
+        return NULL;
+
+    unlink_lru(cache, x);
+    push_lru(cache, x);
+
+    return &cache->paths[x];
+}
+
+void path_cache_put(path_cache* cache, const path_key* key, list* path) {
+    size_t n_of_cities = 0;
+    for (list* l = path; l; l = l->next)
+        n_of_cities++;
+
+    City** cities = NULL;
+    if (path) {
+        cities = (City**)malloc(n_of_cities * sizeof(City*));
+        if (!cities)
+            return;
+    }
+
+    size_t x;
+    if (cache->size < cache->capacity) {
+        x = cache->size++;
+    }
+    else {
+        x = cache->oldest;
+        unlink_lru(cache, x);
+        unlink_bucket(cache, x);
+        free(cache->paths[x].cities);
+    }
+
+    cached_path* p = &cache->paths[x];
+    p->key = *key;
+    p->found = path != NULL;
+    p->cities = cities;
+    p->n_of_cities = n_of_cities;
+    p->length = 0;
+    p->oldest_repair = INT_MAX;
+
+    size_t i = 0;
+    for (list* l = path; l; l = l->next) {
+        cities[i++] = l->city;
+
+        if (l->next) {
+            Road* road = getRoad(l->city, l->next->city);
+            p->length += road->length;
+            if (road->repairYear < p->oldest_repair)
+                p->oldest_repair = road->repairYear;
+        }
+    }
+
+    size_t b = bucket_of(cache, key);
+    p->next = cache->buckets[b];
+    cache->buckets[b] = x;
+    push_lru(cache, x);
+}
+
+list* cached_path_list(const cached_path* path) {
+    list* first = NULL;
+    list* last = NULL;
+
+    for (size_t i = 0; i < path->n_of_cities; i++) {
+        list* l = new_list(path->cities[i]);
+        if (!l) {
+            free_list(first);
+            return NULL;
+        }
+
+        if (last) {
+            last->next = l;
+            l->prev = last;
+        }
+        else {
+            first = l;
+        }
+        last = l;
+    }
+
+    return first;
+}
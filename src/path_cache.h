@@ -0,0 +1,116 @@
+/** @file
+ * Biblioteka implementująca ograniczoną pamięć podręczną wyników
+ * wyszukiwania dróg, usuwającą najdawniej używane wyniki.
+ */
+
+#ifndef DROGI_PATH_CACHE_H
+#define DROGI_PATH_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "specifications.h"
+#include "list.h"
+#include "national_route.h"
+
+/** @brief Typ danych opisujący wyszukiwanie drogi.
+ * Zbiór miast, przez które nie może przechodzić droga, jest reprezentowany
+ * przez liczbę miast i dwa niezależne od kolejności skróty.
+ */
+typedef struct path_key {
+    City* from; ///< Miasto początkowe
+    City* from2; ///< Drugie miasto początkowe lub NULL
+    City* to; ///< Miasto końcowe
+    size_t n_of_excluded; ///< Liczba wykluczonych miast
+    uint64_t sum; ///< Suma skrótów numerów Id wykluczonych miast
+    uint64_t xor_sum; ///< Alternatywa wykluczająca innych skrótów tych numerów
+} path_key;
+
+/** @brief Typ danych przechowujący wynik jednego wyszukiwania.
+ */
+typedef struct cached_path {
+    path_key key; ///< Opis wyszukiwania
+    bool found; ///< Czy znaleziono jednoznaczną drogę
+    City** cities; ///< Kolejne miasta drogi
+    size_t n_of_cities; ///< Liczba miast drogi
+    unsigned length; ///< Długość drogi
+    int oldest_repair; ///< Rok budowy lub ostatniego remontu najstarszego
+    ///< odcinka drogi
+    size_t newer; ///< Wynik użyty później lub @ref NO_PATH
+    size_t older; ///< Wynik użyty wcześniej lub @ref NO_PATH
+    size_t next; ///< Następny wynik w tym samym kubełku lub @ref NO_PATH
+} cached_path;
+
+/** Numer oznaczający brak wyniku. */
+#define NO_PATH SIZE_MAX
+
+/** @brief Typ danych reprezentujący pamięć podręczną wyników.
+ * Wyniki są ważne tylko dla wersji grafu @p epoch.
+ */
+typedef struct path_cache {
+    size_t capacity; ///< Największa liczba wyników
+    size_t size; ///< Liczba zapamiętanych wyników
+    cached_path* paths; ///< Wyniki
+    size_t n_of_buckets; ///< Liczba kubełków, potęga dwójki
+    size_t* buckets; ///< Pierwsze wyniki w kolejnych kubełkach
+    size_t newest; ///< Ostatnio użyty wynik lub @ref NO_PATH
+    size_t oldest; ///< Najdawniej użyty wynik lub @ref NO_PATH
+    unsigned long epoch; ///< Wersja grafu, dla której wyniki są ważne
+} path_cache;
+
+/** @brief Tworzy pustą pamięć podręczną.
+ * @param [in] capacity     - Największa liczba wyników, co najmniej 1.
+ * @return Zwraca wskaźnik na pamięć podręczną lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+path_cache* new_path_cache(size_t capacity);
+
+/** @brief Usuwa pamięć podręczną.
+ * Nic nie robi, jeżeli @p cache ma wartość NULL.
+ * @param [in, out] cache   - Wskaźnik na pamięć podręczną.
+ */
+void free_path_cache(path_cache* cache);
+
+/** @brief Usuwa wyniki, jeżeli graf się zmienił.
+ * @param [in, out] cache   - Wskaźnik na pamięć podręczną;
+ * @param [in] epoch        - Bieżąca wersja grafu.
+ */
+void path_cache_sync(path_cache* cache, unsigned long epoch);
+
+/** @brief Tworzy opis wyszukiwania.
+ * @param [in] from         - Miasto początkowe;
+ * @param [in] from2        - Drugie miasto początkowe lub NULL;
+ * @param [in] to           - Miasto końcowe;
+ * @param [in] excluded     - Droga, przez którą nie może przechodzić
+ * szukana droga, lub NULL.
+ * @return Opis wyszukiwania.
+ */
+path_key make_path_key(City* from, City* from2, City* to,
+                       national_route* excluded);
+
+/** @brief Szuka wyniku wyszukiwania.
+ * Znaleziony wynik staje się ostatnio użytym.
+ * @param [in, out] cache   - Wskaźnik na pamięć podręczną;
+ * @param [in] key          - Opis wyszukiwania.
+ * @return Wskaźnik na wynik lub NULL, jeżeli go nie zapamiętano.
+ */
+cached_path* path_cache_find(path_cache* cache, const path_key* key);
+
+/** @brief Zapamiętuje wynik wyszukiwania.
+ * Jeżeli brakuje miejsca, usuwa najdawniej użyty wynik. Jeżeli nie uda się
+ * zaalokować pamięci, to nic nie zapamiętuje.
+ * @param [in, out] cache   - Wskaźnik na pamięć podręczną;
+ * @param [in] key          - Opis wyszukiwania, którego nie ma w pamięci;
+ * @param [in] path         - Pierwszy element znalezionej drogi lub NULL,
+ * jeżeli nie znaleziono jednoznacznej drogi.
+ */
+void path_cache_put(path_cache* cache, const path_key* key, list* path);
+
+/** @brief Odtwarza drogę z wyniku wyszukiwania.
+ * @param [in] path         - Wynik, w którym znaleziono drogę.
+ * @return Pierwszy element nowej listy miast drogi lub NULL, gdy nie udało
+ * się zaalokować pamięci.
+ */
+list* cached_path_list(const cached_path* path);
+
+#endif //DROGI_PATH_CACHE_H
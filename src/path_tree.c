@@ -0,0 +1,503 @@
+#include "path_tree.h"
+#include <stdlib.h>
+#include <limits.h>
+
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+
+/* Uaktualnienia drzewa używają tablic pamięci roboczej jako znaczników:
+ * reached oznacza miasto podejrzane o utratę najlepszej drogi, excluded
+ * miasto, które ją straciło, settled miasto odwiedzone przy wyznaczaniu
+ * nowych dróg, a reached_back miasto zapisane w touched. */
+
+void free_path_tree(path_tree* t) {
+    if (!t)
+        return;
+
+    free(t->length);
+    free(t->repair);
+    free(t->previous_city);
+    free(t->tied);
+    free(t->touched);
+    free(t);
+}
+
+/** @brief Zapewnia miejsce dla podanej liczby miast.
+ * Nowe miasta są nieosiągalne.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in] n_of_cities  - Liczba miast.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool reserve_path_tree(path_tree* t, size_t n_of_cities) {
+    if (n_of_cities <= t->capacity)
+        return true;
+
+    size_t capacity = 2 * t->capacity;
+    if (capacity < n_of_cities)
+        capacity = n_of_cities;
+
+    /* Tablice powiększamy po kolei, więc po błędzie część z nich jest już
+     * większa, ale drzewo pozostaje spójne dla dotychczasowej liczby miast. */
+    unsigned* length = (unsigned*)realloc(t->length,
+                                          capacity * sizeof(unsigned));
+    if (!length)
+        return false;
+    t->length = length;
+
+    int* repair = (int*)realloc(t->repair, capacity * sizeof(int));
+    if (!repair)
+        return false;
+    t->repair = repair;
+
+    City** previous = (City**)realloc(t->previous_city,
+                                      capacity * sizeof(City*));
+    if (!previous)
+        return false;
+    t->previous_city = previous;
+
+    bool* tied = (bool*)realloc(t->tied, capacity * sizeof(bool));
+    if (!tied)
+        return false;
+    t->tied = tied;
+
+    City** touched = (City**)realloc(t->touched, capacity * sizeof(City*));
+    if (!touched)
+        return false;
+    t->touched = touched;
+
+    for (size_t i = t->capacity; i < capacity; i++) {
+        t->length[i] = 0;
+        t->repair[i] = 0;
+        t->previous_city[i] = NULL;
+        t->tied[i] = false;
+    }
+
+    t->capacity = capacity;
+    return true;
+}
+
+static City* other_end(Road* road, City* city) {
+    return (road->city1 == city) ? road->city2 : road->city1;
+}
+
+static bool is_reached(path_tree* t, City* city) {
+    return city->city_id < t->capacity && t->repair[city->city_id] != 0;
+}
+
+/** @brief Zwraca najlepszą drogę do miasta zapisaną w drzewie.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] city         - Wskaźnik na miasto.
+ * @return Priorytet drogi do @p city.
+ */
+static path_priority tree_key(path_tree* t, City* city) {
+    return make_path(city, t->repair[city->city_id],
+                     t->length[city->city_id]);
+}
+
+/** @brief Wyznacza drogę do sąsiada przedłużającą najlepszą drogę do miasta.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] city         - Wskaźnik na osiągalne miasto;
+ * @param [in] road         - Odcinek drogi wychodzący z @p city.
+ * @return Priorytet drogi do drugiego końca @p road.
+ */
+static path_priority offer(path_tree* t, City* city, Road* road) {
+    size_t id = city->city_id;
+
+    return make_path(other_end(road, city),
+                     MIN(t->repair[id], road->repairYear),
+                     t->length[id] + road->length);
+}
+
+static void set_key(path_tree* t, path_priority pp, City* previous) {
+    t->length[pp.city_id] = pp.total_length;
+    t->repair[pp.city_id] = pp.last_repair;
+    t->previous_city[pp.city_id] = previous;
+    t->tied[pp.city_id] = false;
+}
+
+static void set_unreached(path_tree* t, City* city) {
+    t->length[city->city_id] = 0;
+    t->repair[city->city_id] = 0;
+    t->previous_city[city->city_id] = NULL;
+    t->tied[city->city_id] = false;
+}
+
+/** @brief Zapisuje miasto w @p touched, o ile jeszcze go tam nie ma.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza bieżącego uaktualnienia;
+ * @param [in] city         - Wskaźnik na miasto.
+ */
+static void touch(path_tree* t, search_workspace* ws, City* city) {
+    if (ws->reached_back[city->city_id] == ws->epoch)
+        return;
+
+    ws->reached_back[city->city_id] = ws->epoch;
+    t->touched[t->n_of_touched++] = city;
+}
+
+static bool is_affected(search_workspace* ws, City* city) {
+    return ws->excluded[city->city_id] == ws->epoch;
+}
+
+/** @brief Liczy sąsiadów, przez których prowadzi najlepsza droga do miasta.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] ws           - Pamięć robocza, w której oznaczono miasta do
+ * pominięcia, lub NULL;
+ * @param [in] city         - Wskaźnik na osiągalne miasto;
+ * @param [out] previous    - Ostatni znaleziony taki sąsiad lub NULL.
+ * @return Liczba takich sąsiadów.
+ */
+static size_t count_best(path_tree* t, search_workspace* ws, City* city,
+                         City** previous) {
+    path_priority key = tree_key(t, city);
+    size_t n = 0;
+
+    *previous = NULL;
+    for (road_list* rl = city->roads; rl; rl = rl->next_road) {
+        City* next = other_end(rl->road, city);
+
+        if (!is_reached(t, next) || (ws && is_affected(ws, next)))
+            continue;
+
+        if (compare_priority(offer(t, next, rl->road), key) == 0) {
+            *previous = next;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/** @brief Wyznacza od nowa poprzedniki i niejednoznaczność dróg do miast
+ * zapisanych w @p touched.
+ * Najlepsze drogi do wszystkich miast muszą być już aktualne.
+ * @param [in, out] t       - Wskaźnik na drzewo.
+ */
+static void refresh_touched(path_tree* t) {
+    for (size_t i = 0; i < t->n_of_touched; i++) {
+        City* city = t->touched[i];
+        City* previous;
+
+        if (city == t->source || !is_reached(t, city))
+            continue;
+
+        t->tied[city->city_id] = count_best(t, NULL, city, &previous) > 1;
+        t->previous_city[city->city_id] = previous;
+    }
+}
+
+/** @brief Wyznacza najlepsze drogi do wszystkich miast algorytmem Dijkstry.
+ * @param [in, out] t       - Wskaźnik na drzewo bez osiągalnych miast;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool build_path_tree(path_tree* t, search_workspace* ws) {
+    priority_queue* q = ws->queue;
+    path_priority pp = make_path(t->source, INT_MAX, 0);
+
+    begin_search(ws);
+    set_key(t, pp, NULL);
+    if (!add(q, pp))
+        return false;
+
+    while (!is_empty(q)) {
+        pp = pop(q);
+        City* c = pp.city;
+        ws->settled[c->city_id] = ws->epoch;
+
+        for (road_list* rl = c->roads; rl; rl = rl->next_road) {
+            City* next = other_end(rl->road, c);
+            if (ws->settled[next->city_id] == ws->epoch)
+                continue;
+
+            path_priority o = offer(t, c, rl->road);
+            int cmp = compare_priority(o, tree_key(t, next));
+
+            if (cmp == 0) {
+                t->tied[next->city_id] = true;
+            }
+            else if (cmp > 0) {
+                set_key(t, o, c);
+                if (!add(q, o))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+path_tree* new_path_tree(search_workspace* ws, City* source,
+                         size_t n_of_cities) {
+    path_tree* t = (path_tree*)malloc(sizeof(path_tree));
+    if (!t)
+        return NULL;
+
+    t->source = source;
+    t->capacity = 0;
+    t->length = NULL;
+    t->repair = NULL;
+    t->previous_city = NULL;
+    t->tied = NULL;
+    t->touched = NULL;
+    t->n_of_touched = 0;
+
+    if (!reserve_path_tree(t, n_of_cities) ||
+        !reserve_search_workspace(ws, n_of_cities) ||
+        !build_path_tree(t, ws)) {
+        free_path_tree(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+/** @brief Poprawia drogę do drugiego końca odcinka, jeżeli prowadzi przez
+ * niego lepsza droga.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] city         - Wskaźnik na koniec odcinka;
+ * @param [in] road         - Odcinek drogi.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool improve_from(path_tree* t, search_workspace* ws, City* city,
+                         Road* road) {
+    if (!is_reached(t, city))
+        return true;
+
+    path_priority o = offer(t, city, road);
+    if (compare_priority(o, tree_key(t, o.city)) <= 0)
+        return true;
+
+    set_key(t, o, city);
+    return add(ws->queue, o);
+}
+
+bool path_tree_improve_road(path_tree* t, search_workspace* ws, Road* road,
+                            size_t n_of_cities) {
+    if (!reserve_path_tree(t, n_of_cities) ||
+        !reserve_search_workspace(ws, n_of_cities))
+        return false;
+
+    priority_queue* q = ws->queue;
+    begin_search(ws);
+    t->n_of_touched = 0;
+    touch(t, ws, road->city1);
+    touch(t, ws, road->city2);
+
+    bool ok = improve_from(t, ws, road->city1, road) &&
+              improve_from(t, ws, road->city2, road);
+
+    /* Miasta są zdejmowane z kolejki z ostateczną drogą, a zmiana drogi do
+     * nich może zmienić niejednoznaczność dróg do ich sąsiadów. */
+    while (ok && !is_empty(q)) {
+        City* c = pop(q).city;
+
+        for (road_list* rl = c->roads; ok && rl; rl = rl->next_road) {
+            City* next = other_end(rl->road, c);
+            touch(t, ws, next);
+
+            path_priority o = offer(t, c, rl->road);
+            if (compare_priority(o, tree_key(t, next)) > 0) {
+                set_key(t, o, c);
+                ok = add(q, o);
+            }
+        }
+    }
+
+    if (ok)
+        refresh_touched(t);
+
+    return ok;
+}
+
+/** @brief Oznacza miasto jako podejrzane o utratę najlepszej drogi.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] city         - Wskaźnik na osiągalne miasto.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool suspect(path_tree* t, search_workspace* ws, City* city) {
+    if (ws->reached[city->city_id] == ws->epoch)
+        return true;
+
+    ws->reached[city->city_id] = ws->epoch;
+    touch(t, ws, city);
+    return add(ws->queue, tree_key(t, city));
+}
+
+/** @brief Oznacza drugi koniec odcinka jako podejrzany, jeżeli prowadziła
+ * do niego przez ten odcinek najlepsza droga.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] city         - Wskaźnik na koniec odcinka;
+ * @param [in] road         - Odcinek drogi.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool suspect_through(path_tree* t, search_workspace* ws, City* city,
+                            Road* road) {
+    City* next = other_end(road, city);
+
+    if (!is_reached(t, city) || !is_reached(t, next) ||
+        compare_priority(offer(t, city, road), tree_key(t, next)) != 0)
+        return true;
+
+    return suspect(t, ws, next);
+}
+
+/** @brief Wyznacza miasta, które straciły wszystkie najlepsze drogi.
+ * Podejrzane miasta są rozpatrywane w kolejności dotychczasowych dróg, więc
+ * o każdym sąsiedzie, przez którego prowadziła najlepsza droga do miasta,
+ * wiadomo już, czy sam ją stracił.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool find_affected(path_tree* t, search_workspace* ws) {
+    priority_queue* q = ws->queue;
+    bool ok = true;
+
+    while (ok && !is_empty(q)) {
+        City* c = pop(q).city;
+        City* previous;
+
+        if (count_best(t, ws, c, &previous) > 0)
+            continue;
+
+        ws->excluded[c->city_id] = ws->epoch;
+        for (road_list* rl = c->roads; ok && rl; rl = rl->next_road)
+            ok = suspect_through(t, ws, c, rl->road);
+    }
+
+    return ok;
+}
+
+/** @brief Wyznacza nowe najlepsze drogi do miast, które straciły
+ * dotychczasowe.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] n_of_suspects - Liczba początkowych miast w @p touched,
+ * wśród których są wszystkie miasta, które straciły najlepsze drogi.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
+ */
+static bool reroute_affected(path_tree* t, search_workspace* ws,
+                             size_t n_of_suspects) {
+    priority_queue* q = ws->queue;
+    bool ok = true;
+
+    for (size_t i = 0; i < n_of_suspects; i++) {
+        City* c = t->touched[i];
+        if (!is_affected(ws, c))
+            continue;
+
+        set_unreached(t, c);
+        for (road_list* rl = c->roads; rl; rl = rl->next_road) {
+            City* next = other_end(rl->road, c);
+            touch(t, ws, next);
+
+            if (!is_reached(t, next) || is_affected(ws, next))
+                continue;
+
+            path_priority o = offer(t, next, rl->road);
+            if (compare_priority(o, tree_key(t, c)) > 0)
+                set_key(t, o, next);
+        }
+
+        if (ok && is_reached(t, c))
+            ok = add(q, tree_key(t, c));
+    }
+
+    while (ok && !is_empty(q)) {
+        City* c = pop(q).city;
+        ws->settled[c->city_id] = ws->epoch;
+
+        for (road_list* rl = c->roads; ok && rl; rl = rl->next_road) {
+            City* next = other_end(rl->road, c);
+            if (!is_affected(ws, next) ||
+                ws->settled[next->city_id] == ws->epoch)
+                continue;
+
+            path_priority o = offer(t, c, rl->road);
+            if (compare_priority(o, tree_key(t, next)) > 0) {
+                set_key(t, o, c);
+                ok = add(q, o);
+            }
+        }
+    }
+
+    return ok;
+}
+
+bool path_tree_remove_road(path_tree* t, search_workspace* ws, Road* road,
+                           size_t n_of_cities) {
+    if (!reserve_path_tree(t, n_of_cities) ||
+        !reserve_search_workspace(ws, n_of_cities))
+        return false;
+
+    begin_search(ws);
+    t->n_of_touched = 0;
+    touch(t, ws, road->city1);
+    touch(t, ws, road->city2);
+
+    bool ok = suspect_through(t, ws, road->city1, road) &&
+              suspect_through(t, ws, road->city2, road) &&
+              find_affected(t, ws) &&
+              reroute_affected(t, ws, t->n_of_touched);
+
+    if (ok)
+        refresh_touched(t);
+
+    return ok;
+}
+
+/** @brief Sprawdza, czy najlepsza droga do miasta jest jedyna.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] city         - Wskaźnik na osiągalne miasto.
+ * @return Zwraca @p true jeżeli do każdego miasta na najlepszej drodze do
+ * @p city prowadzi tylko jedna najlepsza droga.
+ */
+static bool is_unique(path_tree* t, City* city) {
+    for (City* c = city; c != t->source; c = t->previous_city[c->city_id]) {
+        if (t->tied[c->city_id])
+            return false;
+    }
+
+    return true;
+}
+
+list* path_tree_path(path_tree* t, City* city) {
+    if (city == t->source || !is_reached(t, city) || !is_unique(t, city))
+        return NULL;
+
+    list* l = new_list(city);
+    if (!l)
+        return NULL;
+
+    for (City* c = city; c != t->source; ) {
+        c = t->previous_city[c->city_id];
+
+        if (!add_to_beginning(l, c)) {
+            free_list(l);
+            return NULL;
+        }
+    }
+
+    return first_elem(l);
+}
+
+route_info path_tree_route(path_tree* t, City* city) {
+    route_info r;
+
+    r.exists = city != t->source && is_reached(t, city);
+    r.unique = r.exists && is_unique(t, city);
+    r.length = r.exists ? t->length[city->city_id] : 0;
+    r.oldest_repair = r.exists ? t->repair[city->city_id] : 0;
+
+    return r;
+}
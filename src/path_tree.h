@@ -0,0 +1,99 @@
+/** @file
+ * Biblioteka definiująca drzewa najlepszych dróg z jednego miasta,
+ * uaktualniane przy zmianach grafu bez ponownego przeszukiwania go całego.
+ */
+
+#ifndef DROGI_PATH_TREE_H
+#define DROGI_PATH_TREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "list.h"
+#include "search_workspace.h"
+#include "graph_operations.h"
+
+/** @brief Typ danych przechowujący najlepsze drogi z miasta początkowego
+ * do wszystkich miast.
+ * Tablice indeksowane są numerami Id miast. Najlepsze drogi są wybierane
+ * tak jak w @ref find_path. Miasto jest nieosiągalne, gdy jego wpis w
+ * @p repair jest równy 0. Poprzednikiem miasta jest jeden z sąsiadów, przez
+ * którego prowadzi najlepsza droga do niego, a wpis w @p tied mówi, czy
+ * takich sąsiadów jest więcej.
+ */
+typedef struct path_tree {
+    City* source; ///< Miasto początkowe
+    size_t capacity; ///< Liczba miast, dla których zaalokowano tablice
+    unsigned* length; ///< Długość najlepszej drogi do miasta
+    int* repair; ///< Rok remontu najstarszego odcinka najlepszej drogi
+    ///< do miasta lub 0, jeżeli miasto jest nieosiągalne
+    City** previous_city; ///< Miasto poprzedzające na najlepszej drodze
+    bool* tied; ///< Czy najlepsza droga do miasta może prowadzić przez
+    ///< różnych sąsiadów
+    City** touched; ///< Miasta, których dotyczy bieżąca zmiana grafu
+    size_t n_of_touched; ///< Liczba miast w @p touched
+} path_tree;
+
+/** @brief Tworzy drzewo najlepszych dróg z miasta.
+ * Przeszukuje cały graf algorytmem Dijkstry.
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] source       - Wskaźnik na miasto początkowe;
+ * @param [in] n_of_cities  - Liczba miast.
+ * @return Zwraca wskaźnik na utworzone drzewo lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+path_tree* new_path_tree(search_workspace* ws, City* source,
+                         size_t n_of_cities);
+
+/** @brief Usuwa drzewo najlepszych dróg.
+ * Nic nie robi, jeżeli @p t ma wartość NULL.
+ * @param [in, out] t       - Wskaźnik na drzewo.
+ */
+void free_path_tree(path_tree* t);
+
+/** @brief Uaktualnia drzewo po dodaniu lub remoncie odcinka drogi.
+ * Drogi do miast mogą się wtedy tylko poprawić, więc są poprawiane
+ * algorytmem Dijkstry zaczętym od końców odcinka i przechodzącym tylko przez
+ * miasta, do których droga się poprawiła.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] road         - Dodany lub wyremontowany odcinek drogi;
+ * @param [in] n_of_cities  - Liczba miast.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, a drzewo
+ * nie nadaje się już do użycia, @p true w przeciwnym wypadku.
+ */
+bool path_tree_improve_road(path_tree* t, search_workspace* ws, Road* road,
+                            size_t n_of_cities);
+
+/** @brief Uaktualnia drzewo po usunięciu odcinka drogi.
+ * Najpierw wyznacza, w kolejności dotychczasowych dróg, miasta, do których
+ * wszystkie najlepsze drogi prowadziły przez usunięty odcinek, a potem
+ * wyznacza drogi tylko do nich, zaczynając od ich pozostałych sąsiadów.
+ * @param [in, out] t       - Wskaźnik na drzewo;
+ * @param [in, out] ws      - Pamięć robocza wyszukiwania;
+ * @param [in] road         - Odłączony już od grafu odcinek drogi;
+ * @param [in] n_of_cities  - Liczba miast.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, a drzewo
+ * nie nadaje się już do użycia, @p true w przeciwnym wypadku.
+ */
+bool path_tree_remove_road(path_tree* t, search_workspace* ws, Road* road,
+                           size_t n_of_cities);
+
+/** @brief Odczytuje z drzewa najlepszą drogę do miasta.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] city         - Wskaźnik na miasto końcowe.
+ * @return Zwraca pierwszy element listy miast drogi z miasta początkowego
+ * do @p city. Zwraca NULL, jeżeli najlepszej drogi nie można jednoznacznie
+ * wyznaczyć lub nie udało się zaalokować pamięci.
+ */
+list* path_tree_path(path_tree* t, City* city);
+
+/** @brief Opisuje najlepszą drogę do miasta.
+ * @param [in] t            - Wskaźnik na drzewo;
+ * @param [in] city         - Wskaźnik na miasto końcowe.
+ * @return Opis najlepszej drogi z miasta początkowego do @p city, taki sam
+ * jak wyznaczany przez @ref search_targets.
+ */
+route_info path_tree_route(path_tree* t, City* city);
+
+#endif //DROGI_PATH_TREE_H
@@ -1,19 +1,12 @@
 #include "priority_queue.h"
 #include "specifications.h"
 
-bool is_empty(priority_queue* q) {
-    if (q->tree[1].last_repair == 0)
-        return true;
+#define INITIAL_CAPACITY 16
 
-    return false;
+bool is_empty(priority_queue* q) {
+    return q->size == 0;
 }
 
-void free_priority_queue(priority_queue* q) {
-    if (q) {
-        free(q->tree);
-        free(q);
-    }
-}
 path_priority empty_route() {
     path_priority route;
 
@@ -21,6 +14,7 @@ path_priority empty_route() {
     route.city_id = 0;
     route.last_repair = 0;
     route.total_length = 0;
+    route.bound = 0;
 
     return route;
 }
@@ -32,14 +26,11 @@ path_priority make_path(City* city, int repair, unsigned length) {
     route.city_id = city->city_id;
     route.last_repair = repair;
     route.total_length = length;
+    route.bound = length;
 
     return route;
 }
 
-path_priority get_city_priority(priority_queue* q, City* city) {
-    return q->tree[city->city_id + q->size];
-}
-
 int compare_priority(path_priority pp1, path_priority pp2) {
     if (pp1.last_repair == 0)
         return -1;
@@ -47,8 +38,14 @@ int compare_priority(path_priority pp1, path_priority pp2) {
     if (pp2.last_repair == 0)
         return 1;
 
-    if (pp1.total_length != pp2.total_length)
-        return pp2.total_length - pp1.total_length;
+    /* Ograniczenie i długość porównujemy naraz jako jedną liczbę. */
+    unsigned long long key1 = ((unsigned long long)pp1.bound << 32) |
+                              pp1.total_length;
+    unsigned long long key2 = ((unsigned long long)pp2.bound << 32) |
+                              pp2.total_length;
+
+    if (key1 != key2)
+        return (key1 < key2) ? 1 : -1;
 
     if (pp1.last_repair != pp2.last_repair)
         return pp1.last_repair - pp2.last_repair;
@@ -56,64 +53,292 @@ int compare_priority(path_priority pp1, path_priority pp2) {
     return 0;
 }
 
-priority_queue* make_priority_queue(size_t size) {
-    size_t k = 1;
-    while (k < size) k *= 2;
+/* Kopiec, w którym leży droga do miasta znajdującego się w kolejce. */
+static queue_heap* heap_of(priority_queue* q, unsigned city_id) {
+    if (q->slot && q->slot[city_id] != 0)
+        return &q->buckets[q->slot[city_id] - 1];
+
+    return &q->heap;
+}
+
+path_priority get_city_priority(priority_queue* q, City* city) {
+    size_t x = q->position[city->city_id];
+
+    if (x == 0)
+        return empty_route();
+
+    return heap_of(q, city->city_id)->items[x - 1];
+}
+
+static void put(priority_queue* q, queue_heap* h, size_t x,
+                path_priority route) {
+    h->items[x] = route;
+    q->position[route.city_id] = x + 1;
+}
+
+static void sift_up(priority_queue* q, queue_heap* h, size_t x) {
+    path_priority route = h->items[x];
+
+    while (x > 0) {
+        size_t parent = (x - 1) / HEAP_ARITY;
+
+        if (compare_priority(h->items[parent], route) >= 0)
+            break;
+
+        put(q, h, x, h->items[parent]);
+        x = parent;
+    }
+
+    put(q, h, x, route);
+}
+
+static void sift_down(priority_queue* q, queue_heap* h, size_t x) {
+    path_priority route = h->items[x];
+
+    while (true) {
+        size_t first = x * HEAP_ARITY + 1;
+        if (first >= h->size)
+            break;
+
+        size_t last = first + HEAP_ARITY;
+        if (last > h->size)
+            last = h->size;
+
+        size_t best = first;
+        for (size_t i = first + 1; i < last; i++) {
+            if (compare_priority(h->items[i], h->items[best]) > 0)
+                best = i;
+        }
+
+        if (compare_priority(h->items[best], route) <= 0)
+            break;
+
+        put(q, h, x, h->items[best]);
+        x = best;
+    }
+
+    put(q, h, x, route);
+}
+
+static bool heap_push(priority_queue* q, queue_heap* h, path_priority route) {
+    if (h->size == h->capacity) {
+        size_t capacity = h->capacity ? 2 * h->capacity : INITIAL_CAPACITY;
+        path_priority* items = (path_priority*)realloc(h->items,
+                                                       capacity * sizeof(path_priority));
+        if (!items)
+            return false;
+
+        h->items = items;
+        h->capacity = capacity;
+    }
+
+    h->items[h->size] = route;
+    h->size++;
+    sift_up(q, h, h->size - 1);
+
+    return true;
+}
+
+static void heap_remove(priority_queue* q, queue_heap* h, size_t x) {
+    q->position[h->items[x].city_id] = 0;
+    h->size--;
+
+    if (x < h->size) {
+        path_priority route = h->items[h->size];
+
+        put(q, h, x, route);
+        if (x > 0 &&
+            compare_priority(h->items[(x - 1) / HEAP_ARITY], route) < 0)
+            sift_up(q, h, x);
+        else
+            sift_down(q, h, x);
+    }
+}
+
+static void free_buckets(priority_queue* q) {
+    for (size_t i = 0; i < q->n_of_buckets; i++)
+        free(q->buckets[i].items);
+
+    free(q->buckets);
+    free(q->slot);
+    q->buckets = NULL;
+    q->slot = NULL;
+    q->n_of_buckets = 0;
+    q->in_buckets = 0;
+}
+
+void free_priority_queue(priority_queue* q) {
+    if (q) {
+        free_buckets(q);
+        free(q->heap.items);
+        free(q->position);
+        free(q);
+    }
+}
 
+priority_queue* make_priority_queue(size_t size) {
     priority_queue* q = (priority_queue*)malloc(sizeof(priority_queue));
     if (!q)
         return NULL;
 
-    q->tree = (path_priority*)malloc(2 * k * sizeof(path_priority));
-    if (!q->tree) {
-        free(q);
+    q->buckets = NULL;
+    q->slot = NULL;
+    q->n_of_buckets = 0;
+    q->in_buckets = 0;
+    q->lowest = 0;
+    q->heap.items = NULL;
+    q->heap.size = 0;
+    q->heap.capacity = 0;
+    /* Duże wyzerowane bloki system dostarcza leniwie, więc koszt tablicy
+     * pozycji rośnie z liczbą miast, które faktycznie trafią do kolejki. */
+    q->position = (size_t*)calloc(size > 0 ? size : 1, sizeof(size_t));
+    if (!q->position) {
+        free_priority_queue(q);
         return NULL;
     }
-    q->size = k;
 
-    for (size_t i = 0; i < 2 * k; i++)
-        q->tree[i] = empty_route();
+    q->size = 0;
+    q->n_of_cities = size;
 
     return q;
 }
 
-void add(priority_queue* q, path_priority route) {
-    size_t x = route.city_id + q->size;
+/* Wybiera kopiec dla drogi o podanym ograniczeniu: kubełek, jeżeli
+ * ograniczenie mieści się w oknie kubełków, a wspólny kopiec w przeciwnym
+ * wypadku. */
+static queue_heap* heap_for(priority_queue* q, unsigned bound) {
+    if (!q->buckets)
+        return &q->heap;
 
-    if (compare_priority(q->tree[x], route) <= 0)
-        q->tree[x] = route;
-    else
-        return;
+    if (q->in_buckets == 0)
+        q->lowest = bound;
 
-    x /= 2;
+    if (bound < q->lowest || bound - q->lowest >= q->n_of_buckets)
+        return &q->heap;
 
-    while (x != 0) {
-        if(compare_priority(q->tree[x], route) < 0)
-            q->tree[x] = route;
+    return &q->buckets[bound & (q->n_of_buckets - 1)];
+}
 
-        x /= 2;
+bool add(priority_queue* q, path_priority route) {
+    size_t x = q->position[route.city_id];
+    queue_heap* h = NULL;
+
+    if (x != 0) {
+        h = heap_of(q, route.city_id);
+        if (compare_priority(h->items[x - 1], route) > 0)
+            return true;
+
+        /* Lepsza droga w tym samym kopcu może się tylko przesunąć w górę. */
+        if (!q->buckets || h == heap_for(q, route.bound)) {
+            h->items[x - 1] = route;
+            sift_up(q, h, x - 1);
+            return true;
+        }
+
+        heap_remove(q, h, x - 1);
+        q->size--;
+        if (h != &q->heap)
+            q->in_buckets--;
     }
+
+    h = heap_for(q, route.bound);
+    if (!heap_push(q, h, route))
+        return false;
+
+    q->size++;
+    if (h != &q->heap) {
+        q->in_buckets++;
+        q->slot[route.city_id] = (unsigned)(h - q->buckets) + 1;
+    } else if (q->slot) {
+        q->slot[route.city_id] = 0;
+    }
+
+    return true;
+}
+
+/* Kopiec, na którego szczycie leży najlepsza droga w kolejce. Kubełki
+ * przed pierwszym niepustym są pomijane na stałe, bo ograniczenia dróg
+ * dodawanych do kubełków nie są mniejsze od @p lowest. */
+static queue_heap* best_heap(priority_queue* q) {
+    if (q->in_buckets == 0)
+        return &q->heap;
+
+    size_t mask = q->n_of_buckets - 1;
+    while (q->buckets[q->lowest & mask].size == 0)
+        q->lowest++;
+
+    queue_heap* b = &q->buckets[q->lowest & mask];
+    if (q->heap.size == 0 ||
+        compare_priority(b->items[0], q->heap.items[0]) >= 0)
+        return b;
+
+    return &q->heap;
 }
 
 path_priority pop(priority_queue* q) {
-    path_priority route = q->tree[1];
+    queue_heap* h = best_heap(q);
+    path_priority route = h->items[0];
 
-    size_t x = route.city_id + q->size;
-    q->tree[x] = empty_route();
-    x /= 2;
+    heap_remove(q, h, 0);
+    q->size--;
+    if (h != &q->heap)
+        q->in_buckets--;
 
-    while (x != 0) {
-        q->tree[x] = empty_route();
+    return route;
+}
 
-        if (compare_priority(q->tree[2 * x], q->tree[2 * x + 1]) < 0)
-            q->tree[x] = q->tree[2 * x + 1];
-        else
-            q->tree[x] = q->tree[2 * x];
+path_priority top(priority_queue* q) {
+    return best_heap(q)->items[0];
+}
 
+void clear_priority_queue(priority_queue* q) {
+    for (size_t i = 0; i < q->heap.size; i++)
+        q->position[q->heap.items[i].city_id] = 0;
 
+    q->heap.size = 0;
 
-        x /= 2;
+    /* Wszystkie niepuste kubełki leżą w oknie zaczynającym się od lowest. */
+    for (unsigned i = q->lowest; q->in_buckets > 0; i++) {
+        queue_heap* b = &q->buckets[i & (q->n_of_buckets - 1)];
+
+        for (size_t j = 0; j < b->size; j++)
+            q->position[b->items[j].city_id] = 0;
+
+        q->in_buckets -= b->size;
+        b->size = 0;
     }
 
-    return route;
-}
\ No newline at end of file
+    q->size = 0;
+}
+
+void tune_priority_queue(priority_queue* q, unsigned max_length) {
+    if (q->size > 0)
+        return;
+
+    size_t n_of_buckets = 0;
+    if (max_length > 0 && max_length < MAX_BUCKETS / 2) {
+        n_of_buckets = 1;
+        while (n_of_buckets < 2 * (size_t)max_length + 1)
+            n_of_buckets *= 2;
+    }
+
+    if (n_of_buckets == q->n_of_buckets)
+        return;
+
+    free_buckets(q);
+    if (n_of_buckets == 0)
+        return;
+
+    q->buckets = (queue_heap*)calloc(n_of_buckets, sizeof(queue_heap));
+    q->slot = (unsigned*)calloc(q->n_of_cities > 0 ? q->n_of_cities : 1,
+                                sizeof(unsigned));
+    if (!q->buckets || !q->slot) {
+        free(q->buckets);
+        free(q->slot);
+        q->buckets = NULL;
+        q->slot = NULL;
+        return;
+    }
+
+    q->n_of_buckets = n_of_buckets;
+}
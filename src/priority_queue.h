@@ -7,29 +7,74 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include "specifications.h"
 /** @brief Typ danych wyznaczający priorytet danej drogi.
  */
 typedef struct path_priority {
     int last_repair; ///< Rok remontu lub budowy najstarszego odcinka drogi
     unsigned total_length; ///< Długość całej drogi
-    size_t city_id; ///< Numer Id ostatniego miasta na drodze
+    unsigned bound; ///< Dolne ograniczenie długości drogi do miasta
+    ///< końcowego przedłużającej tę drogę, co najmniej @p total_length
+    unsigned city_id; ///< Numer Id ostatniego miasta na drodze
     City* city; ///< Wskaźnik na strukturę reprezentującą ostatnie miasto
     ///< na drodze
 } path_priority;
 
+/** @brief Liczba synów każdego wierzchołka kopca.
+ */
+#define HEAP_ARITY 4
+
+/** @brief Największa liczba kubełków kolejki.
+ * Kolejka używa kubełków tylko wtedy, gdy dwukrotność najdłuższego odcinka
+ * drogi jest mniejsza od tej liczby.
+ */
+#define MAX_BUCKETS 2048
+
+/** @brief Typ danych reprezentujący indeksowany kopiec d-arny dróg.
+ */
+typedef struct queue_heap {
+    path_priority* items; ///< Kopiec z drogami, na szczycie najlepsza droga
+    size_t size; ///< Liczba dróg w kopcu
+    size_t capacity; ///< Liczba miejsc zaalokowanych w tablicy @p items
+} queue_heap;
+
 /** @brief Typ danych reprezentujący kolejkę priorytetową.
  * Typ danych reprezentującą kolejkę priorytetową. Elementy kolejki są
- * typu @c path_priority.
+ * typu @c path_priority. Kolejka jest indeksowanym kopcem d-arnym:
+ * dla każdego miasta pamiętana jest pozycja jego drogi w kopcu, więc
+ * poprawienie priorytetu nie wymaga szukania elementu. Zajmowana pamięć
+ * (poza tablicą pozycji) rośnie wraz z liczbą elementów kolejki.
+ * Gdy odcinki dróg są krótkie, kolejka jest kolejką kubełkową Diala:
+ * drogi o ograniczeniu z okna o szerokości @p n_of_buckets zaczynającego
+ * się od @p lowest trafiają do kubełka wyznaczonego przez to ograniczenie,
+ * a w obrębie kubełka są ułożone w kopiec według długości i roku remontu.
+ * Pozostałe drogi, na przykład dodane w kolejności innej niż rosnąca,
+ * trafiają do wspólnego kopca @p heap, więc kolejność zdejmowania dróg nie
+ * zależy od sposobu ich przechowywania.
  */
 typedef struct priority_queue {
-    size_t size; ///< Maksymalna pojemność kolejki
-    path_priority* tree; ///< Struktura reprezentująca kolejkę priorytetową
+    size_t size; ///< Liczba elementów w kolejce
+    size_t n_of_cities; ///< Rozmiar tablicy @p position
+    queue_heap heap; ///< Kopiec z drogami spoza kubełków
+    size_t* position; ///< Pozycja drogi do miasta w jej kopcu powiększona
+    ///< o jeden, @p 0 jeżeli miasta nie ma w kolejce
+    queue_heap* buckets; ///< Kubełki lub NULL, gdy kolejka jest kopcem
+    size_t n_of_buckets; ///< Liczba kubełków, potęga dwójki lub 0
+    size_t in_buckets; ///< Liczba elementów we wszystkich kubełkach
+    unsigned* slot; ///< Numer kubełka drogi do miasta powiększony o jeden,
+    ///< @p 0 jeżeli droga jest w kopcu @p heap
+    unsigned lowest; ///< Ograniczenie długości nie większe od ograniczeń
+    ///< wszystkich dróg w kubełkach
 } priority_queue;
 
 /** @brief Porównuje priorytet dwóch dróg.
- * Porównuje dwie drogi pod względem całkowitej długości. Jeżeli są \
- * rownej długości, to porónuje po najstarszym odcinku drogi w obu drogach.
+ * Porównuje dwie drogi najpierw pod względem dolnego ograniczenia długości
+ * drogi do miasta końcowego, a potem pod względem całkowitej długości.
+ * Jeżeli są rownej długości, to porónuje po najstarszym odcinku drogi w obu
+ * drogach.
+ * Dla dróg do tego samego miasta ograniczenia różnią się tak samo jak
+ * długości, więc porównanie ograniczeń nie zmienia wyniku.
  * @param [in] pp1      - Struktura opisująca drogę.
  * @param [in] pp2      - Struktura opisująca drogę.
  * @return Zwraca @p 0 jeżeli drogi @p pp1 i @p pp2 są równej długości i ich
@@ -78,6 +123,7 @@ bool is_empty(priority_queue* q);
 /** @brief Tworzy struktuę reprezentującą drogę do danego miasta.
  *  Tworzy strukturę reprezentującą drogę do miasta @p city. Jest ona długości
  *  @p length i najstarszy odcinek drogi w niech pchodzi z roku @p repair.
+ *  Dolnym ograniczeniem jest sama długość @p length.
  * @param city          - Wskaźnik na strukturę reprezentującą miasto;
  * @param repair        - Rok budowy lub remontu najstarszego odcinka drogi.
  * @param length        - Długość drogi w km.
@@ -87,8 +133,8 @@ bool is_empty(priority_queue* q);
 path_priority make_path(City *city, int repair, unsigned length);
 
 /** @brief Tworzy kolejkę priorytetową.
- * Tworzy kolejkę priorytetową, która może pomieścić @p size elementów.
- * @param [in] size     - Maksymalny rozmiar kolejki priorytetowej.
+ * Tworzy kolejkę priorytetową dla miast o numerach Id mniejszych niż @p size.
+ * @param [in] size     - Liczba miast.
  * @return Zwraca wskaźnik na kolejkę priorytetową. Zwraca NULL jeżeli nie
  * uda się zaalokować pamięci.
  */
@@ -101,8 +147,10 @@ priority_queue* make_priority_queue(size_t size);
  *  do którego prowadzi @p route, to nic nie robi.
  * @param [in, out]         - Wskaźnik na kolejkę priorytetową.
  * @param route             - Struktura opisująca drogę.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci,
+ * @p true w przeciwnym wypadku.
  */
-void add(priority_queue* q, path_priority route);
+bool add(priority_queue* q, path_priority route);
 
 /** @brief Pobiera i usuwa element o największym priorytecie z kolejki.
  * Pobiera element o największym priorytecie z kolejki @p q i go z niej
@@ -112,4 +160,31 @@ void add(priority_queue* q, path_priority route);
  */
 path_priority pop(priority_queue* q);
 
+/** @brief Zwraca element o największym priorytecie, nie usuwając go.
+ * Kolejka @p q nie może być pusta.
+ * @param [in] q            - Wskaźnik na kolejkę priorytetową.
+ * @return Zwraca strukturę opisującą drogę o największym priorytecie.
+ */
+path_priority top(priority_queue* q);
+
+/** @brief Usuwa wszystkie elementy z kolejki.
+ * Opróżnia kolejkę @p q w czasie proporcjonalnym do liczby jej elementów,
+ * dzięki czemu można jej użyć ponownie bez tworzenia nowej.
+ * @param [in, out] q       - Wskaźnik na kolejkę priorytetową.
+ */
+void clear_priority_queue(priority_queue* q);
+
+/** @brief Dobiera sposób przechowywania elementów kolejki do długości
+ * odcinków dróg.
+ * Jeżeli ograniczenia dróg dodawanych po zdjęciu drogi z kolejki rosną
+ * o co najwyżej dwukrotność długości odcinka, a najdłuższy odcinek jest
+ * krótki, to kolejka zaczyna używać kubełków, a w przeciwnym wypadku kopca.
+ * Nic nie robi, jeżeli kolejka @p q nie jest pusta. Jeżeli nie uda się
+ * zaalokować pamięci na kubełki, kolejka pozostaje kopcem.
+ * @param [in, out] q       - Wskaźnik na kolejkę priorytetową;
+ * @param [in] max_length   - Długość najdłuższego odcinka drogi lub 0, gdy
+ * nie jest znana.
+ */
+void tune_priority_queue(priority_queue* q, unsigned max_length);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "route_index.h"
+
+void init_route_uses(object_pool* uses) {
+    init_object_pool(uses, sizeof(route_use));
+}
+
+bool reserve_route_uses(object_pool* uses, size_t n) {
+    /* Przydzielone wpisy oddajemy od razu do puli, z której następne
+     * przydziały biorą najpierw zwolnione obiekty. */
+    void* reserved = NULL;
+    bool ok = true;
+
+    for (size_t i = 0; i < n; i++) {
+        void* object = pool_alloc(uses);
+        if (!object) {
+            ok = false;
+            break;
+        }
+
+        *(void**)object = reserved;
+        reserved = object;
+    }
+
+    while (reserved) {
+        void* next = *(void**)reserved;
+        pool_free(uses, reserved);
+        reserved = next;
+    }
+
+    return ok;
+}
+
+bool index_path(object_pool* uses, unsigned route_id, list* path) {
+    for (list* l = path; l->next; l = l->next) {
+        route_use* use = (route_use*)pool_alloc(uses);
+        if (!use) {
+            /* Wpisy dodane wcześniej są pierwsze na listach swoich
+             * odcinków. */
+            for (list* k = path; k != l; k = k->next) {
+                Road* road = getRoad(k->city, k->next->city);
+                route_use* added = road->routes;
+
+                road->routes = added->next;
+                if (road->routes)
+                    road->routes->prev = NULL;
+                pool_free(uses, added);
+            }
+
+            return false;
+        }
+
+        use->route_id = route_id;
+        use->road = getRoad(l->city, l->next->city);
+        use->prev = NULL;
+        use->next = use->road->routes;
+        if (use->next)
+            use->next->prev = use;
+        use->road->routes = use;
+    }
+
+    return true;
+}
+
+void unindex_road(object_pool* uses, Road* road) {
+    while (road->routes) {
+        route_use* use = road->routes;
+
+        road->routes = use->next;
+        pool_free(uses, use);
+    }
+}
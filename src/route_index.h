@@ -0,0 +1,61 @@
+/** @file
+ * Biblioteka definiująca indeks odcinków drogi należących do dróg
+ * krajowych, pozwalający znaleźć drogi krajowe przechodzące przez odcinek
+ * bez przeglądania wszystkich dróg krajowych.
+ */
+
+#ifndef DROGI_ROUTE_INDEX_H
+#define DROGI_ROUTE_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "object_pool.h"
+#include "list.h"
+
+/** @brief Typ danych opisujący przejście drogi krajowej przez odcinek drogi.
+ * Wpisy jednego odcinka tworzą listę dwukierunkową zaczynającą się
+ * w @ref Road::routes. Miejsce odcinka na drodze krajowej wyznacza się
+ * z etykiet jego końców, więc wpisy nie zmieniają się, gdy droga krajowa
+ * rośnie.
+ */
+typedef struct route_use {
+    unsigned route_id; ///< Numer drogi krajowej
+    Road* road; ///< Odcinek drogi
+    struct route_use* next; ///< Następny wpis odcinka
+    struct route_use* prev; ///< Poprzedni wpis odcinka
+} route_use;
+
+/** @brief Inicjalizuje pustą pulę wpisów indeksu.
+ * @param [out] uses        - Pula wpisów.
+ */
+void init_route_uses(object_pool* uses);
+
+/** @brief Zapewnia, że kolejne @p n wpisów zostanie przydzielonych bez
+ * alokowania pamięci.
+ * @param [in, out] uses    - Pula wpisów;
+ * @param [in] n            - Liczba wpisów.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, @p true
+ * w przeciwnym wypadku.
+ */
+bool reserve_route_uses(object_pool* uses, size_t n);
+
+/** @brief Dodaje do indeksu odcinki drogi krajowej.
+ * Dodaje odcinki pomiędzy kolejnymi miastami listy. Jeżeli nie uda się
+ * zaalokować pamięci, to indeks pozostaje bez zmian.
+ * @param [in, out] uses    - Pula wpisów;
+ * @param [in] route_id     - Numer drogi krajowej;
+ * @param [in] path         - Wskaźnik na pierwszy element listy miast
+ * kolejno połączonych odcinkami drogi.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, @p true
+ * w przeciwnym wypadku.
+ */
+bool index_path(object_pool* uses, unsigned route_id, list* path);
+
+/** @brief Usuwa z indeksu wszystkie przejścia dróg krajowych przez odcinek.
+ * @param [in, out] uses    - Pula wpisów;
+ * @param [in, out] road    - Odcinek drogi.
+ */
+void unindex_road(object_pool* uses, Road* road);
+
+#endif //DROGI_ROUTE_INDEX_H
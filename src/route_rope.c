@@ -0,0 +1,225 @@
+#include "route_rope.h"
+
+void init_rope_nodes(object_pool* nodes) {
+    init_object_pool(nodes, sizeof(rope_node));
+}
+
+bool reserve_rope_nodes(object_pool* nodes, size_t n) {
+    /* Przydzielone węzły oddajemy od razu do puli, z której następne
+     * przydziały biorą najpierw zwolnione obiekty. */
+    void* reserved = NULL;
+    bool ok = true;
+
+    for (size_t i = 0; i < n; i++) {
+        void* object = pool_alloc(nodes);
+        if (!object) {
+            ok = false;
+            break;
+        }
+
+        *(void**)object = reserved;
+        reserved = object;
+    }
+
+    while (reserved) {
+        void* next = *(void**)reserved;
+        pool_free(nodes, reserved);
+        reserved = next;
+    }
+
+    return ok;
+}
+
+size_t rope_size(rope_node* t) {
+    return t ? t->size : 0;
+}
+
+unsigned rope_height(rope_node* t) {
+    return t ? t->height : 0;
+}
+
+/* Poprawia pola węzła opisujące całe poddrzewo po zmianie synów. */
+static void update(rope_node* t) {
+    unsigned hl = rope_height(t->left), hr = rope_height(t->right);
+
+    t->height = 1 + (hl > hr ? hl : hr);
+    t->size = 1 + rope_size(t->left) + rope_size(t->right);
+    t->length = t->next ? t->next->length : 0;
+    if (t->left)
+        t->length += t->left->length;
+    if (t->right)
+        t->length += t->right->length;
+}
+
+rope_node* new_rope_node(object_pool* nodes, City* city,
+                         unsigned long long label, unsigned priority) {
+    rope_node* t = (rope_node*)pool_alloc(nodes);
+    if (!t)
+        return NULL;
+
+    t->left = t->right = NULL;
+    t->city = city;
+    t->next = NULL;
+    t->label = label;
+    t->priority = priority;
+    t->refs = 1;
+    update(t);
+
+    return t;
+}
+
+rope_node* retain_rope(rope_node* t) {
+    if (t)
+        t->refs++;
+
+    return t;
+}
+
+void release_rope(object_pool* nodes, rope_node* t) {
+    while (t && --t->refs == 0) {
+        rope_node* right = t->right;
+
+        release_rope(nodes, t->left);
+        pool_free(nodes, t);
+        t = right;
+    }
+}
+
+/* Zwraca węzeł, który można zmieniać w miejsce przejętego wskazania na t:
+ * sam węzeł, jeżeli nikt inny na niego nie wskazuje, a w przeciwnym
+ * wypadku jego kopię. */
+static rope_node* own(object_pool* nodes, rope_node* t) {
+    if (t->refs == 1)
+        return t;
+
+    rope_node* copy = (rope_node*)pool_alloc(nodes);
+
+    *copy = *t;
+    copy->refs = 1;
+    retain_rope(copy->left);
+    retain_rope(copy->right);
+    t->refs--;
+
+    return copy;
+}
+
+void split_rope(object_pool* nodes, rope_node* t, size_t k, rope_node** l,
+                rope_node** r) {
+    if (!t) {
+        *l = *r = NULL;
+        return;
+    }
+
+    t = own(nodes, t);
+    if (k <= rope_size(t->left)) {
+        split_rope(nodes, t->left, k, l, &t->left);
+        *r = t;
+    }
+    else {
+        split_rope(nodes, t->right, k - rope_size(t->left) - 1, &t->right, r);
+        *l = t;
+    }
+
+    update(t);
+}
+
+/* Zapisuje odcinek za ostatnim miastem ciągu. */
+static rope_node* set_last_road(object_pool* nodes, rope_node* t,
+                                Road* join) {
+    t = own(nodes, t);
+    if (t->right)
+        t->right = set_last_road(nodes, t->right, join);
+    else
+        t->next = join;
+
+    update(t);
+    return t;
+}
+
+rope_node* merge_ropes(object_pool* nodes, rope_node* l, rope_node* r,
+                       Road* join) {
+    if (!l)
+        return r;
+    if (!r)
+        return set_last_road(nodes, l, join);
+
+    if (l->priority >= r->priority) {
+        l = own(nodes, l);
+        if (!l->right)
+            l->next = join;
+        l->right = merge_ropes(nodes, l->right, r, join);
+        update(l);
+        return l;
+    }
+
+    r = own(nodes, r);
+    r->left = merge_ropes(nodes, l, r->left, join);
+    update(r);
+    return r;
+}
+
+rope_node* rope_first(rope_node* t) {
+    while (t->left)
+        t = t->left;
+
+    return t;
+}
+
+rope_node* rope_last(rope_node* t) {
+    while (t->right)
+        t = t->right;
+
+    return t;
+}
+
+rope_node* rope_at(rope_node* t, size_t i) {
+    while (i != rope_size(t->left)) {
+        if (i < rope_size(t->left)) {
+            t = t->left;
+        }
+        else {
+            i -= rope_size(t->left) + 1;
+            t = t->right;
+        }
+    }
+
+    return t;
+}
+
+rope_node* find_label(rope_node* t, unsigned long long label,
+                      size_t* position) {
+    *position = 0;
+    while (t->label != label) {
+        if (label < t->label) {
+            t = t->left;
+        }
+        else {
+            *position += rope_size(t->left) + 1;
+            t = t->right;
+        }
+    }
+
+    *position += rope_size(t->left);
+    return t;
+}
+
+rope_node* relabel_rope(object_pool* nodes, rope_node* t,
+                        unsigned long long* label, unsigned long long step) {
+    if (!t)
+        return NULL;
+
+    t = own(nodes, t);
+    t->left = relabel_rope(nodes, t->left, label, step);
+    t->label = *label;
+    *label += step;
+    t->right = relabel_rope(nodes, t->right, label, step);
+
+    return t;
+}
+
+void walk_rope(rope_node* t, rope_visitor visit, void* arg) {
+    for (; t; t = t->right) {
+        walk_rope(t->left, visit, arg);
+        visit(arg, t);
+    }
+}
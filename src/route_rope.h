@@ -0,0 +1,167 @@
+/** @file
+ * Biblioteka definiująca trwały ciąg miast drogi krajowej, przechowywany
+ * w drzewie, którego węzły są współdzielone przez kolejne wersje ciągu.
+ */
+
+#ifndef DROGI_ROUTE_ROPE_H
+#define DROGI_ROUTE_ROPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "object_pool.h"
+
+/** @brief Typ danych reprezentujący węzeł ciągu miast.
+ * Drzewo jest drzewcem: kolejność miast wyznacza porządek węzłów
+ * w drzewie, a priorytet ojca jest nie mniejszy od priorytetów synów.
+ * Węzeł, na który wskazuje więcej niż jeden ojciec lub wersja ciągu, nie
+ * jest już zmieniany, a operacje zmieniające ciąg kopiują węzły na
+ * ścieżkach, którymi schodzą. Dzięki temu stara wersja ciągu pozostaje
+ * ważna tak długo, jak długo ktoś trzyma wskaźnik na jej korzeń.
+ */
+typedef struct rope_node {
+    struct rope_node* left; ///< Lewy syn lub NULL
+    struct rope_node* right; ///< Prawy syn lub NULL
+    City* city; ///< Miasto drogi
+    Road* next; ///< Odcinek do następnego miasta ciągu lub NULL
+    unsigned long long label; ///< Etykieta miasta, rosnąca wzdłuż ciągu
+    unsigned priority; ///< Losowy priorytet węzła
+    unsigned refs; ///< Liczba ojców i wersji wskazujących na węzeł
+    unsigned height; ///< Wysokość poddrzewa
+    size_t size; ///< Liczba miast w poddrzewie
+    unsigned long long length; ///< Suma długości odcinków @p next poddrzewa
+} rope_node;
+
+/** @brief Typ funkcji odwiedzającej kolejne węzły ciągu.
+ * @param [in, out] arg     - Dane przekazane do @ref walk_rope;
+ * @param [in] node         - Odwiedzany węzeł.
+ */
+typedef void (*rope_visitor)(void* arg, rope_node* node);
+
+/** @brief Inicjalizuje pustą pulę węzłów.
+ * @param [out] nodes       - Pula węzłów.
+ */
+void init_rope_nodes(object_pool* nodes);
+
+/** @brief Zapewnia, że kolejne @p n węzłów zostanie przydzielonych bez
+ * alokowania pamięci.
+ * @param [in, out] nodes   - Pula węzłów;
+ * @param [in] n            - Liczba węzłów.
+ * @return Zwraca @p false jeżeli nie udało się zaalokować pamięci, @p true
+ * w przeciwnym wypadku.
+ */
+bool reserve_rope_nodes(object_pool* nodes, size_t n);
+
+/** @brief Tworzy ciąg złożony z jednego miasta.
+ * @param [in, out] nodes   - Pula węzłów;
+ * @param [in] city         - Miasto;
+ * @param [in] label        - Etykieta miasta;
+ * @param [in] priority     - Losowy priorytet węzła.
+ * @return Zwraca wskaźnik na nowy węzeł lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+rope_node* new_rope_node(object_pool* nodes, City* city,
+                         unsigned long long label, unsigned priority);
+
+/** @brief Zapamiętuje dodatkowe wskazanie na wersję ciągu.
+ * @param [in, out] t       - Korzeń ciągu lub NULL.
+ * @return Wskaźnik @p t.
+ */
+rope_node* retain_rope(rope_node* t);
+
+/** @brief Porzuca wskazanie na wersję ciągu.
+ * Oddaje do puli węzły, na które nic już nie wskazuje.
+ * @param [in, out] nodes   - Pula węzłów;
+ * @param [in, out] t       - Korzeń ciągu lub NULL.
+ */
+void release_rope(object_pool* nodes, rope_node* t);
+
+/** @brief Zwraca liczbę miast ciągu.
+ * @param [in] t            - Korzeń ciągu lub NULL.
+ * @return Liczba miast.
+ */
+size_t rope_size(rope_node* t);
+
+/** @brief Zwraca wysokość drzewa ciągu.
+ * @param [in] t            - Korzeń ciągu lub NULL.
+ * @return Wysokość drzewa, 0 dla pustego ciągu.
+ */
+unsigned rope_height(rope_node* t);
+
+/** @brief Dzieli ciąg na początkowe @p k miast i resztę.
+ * Przejmuje wskazanie na @p t. Odcinek @p next ostatniego miasta pierwszej
+ * części wskazuje dalej na odcinek do miasta drugiej części, dopóki nie
+ * zostanie ustawiony przez @ref merge_ropes. Kopiuje co najwyżej
+ * @ref rope_height (@p t) węzłów.
+ * @param [in, out] nodes   - Pula węzłów z zarezerwowanym miejscem na kopie;
+ * @param [in, out] t       - Korzeń ciągu;
+ * @param [in] k            - Liczba miast pierwszej części;
+ * @param [out] l           - Korzeń pierwszej części;
+ * @param [out] r           - Korzeń drugiej części.
+ */
+void split_rope(object_pool* nodes, rope_node* t, size_t k, rope_node** l,
+                rope_node** r);
+
+/** @brief Łączy dwa ciągi.
+ * Przejmuje wskazania na @p l i @p r. Kopiuje co najwyżej
+ * 2 * @ref rope_height (@p l) + @ref rope_height (@p r) węzłów.
+ * @param [in, out] nodes   - Pula węzłów z zarezerwowanym miejscem na kopie;
+ * @param [in, out] l       - Korzeń pierwszego ciągu lub NULL;
+ * @param [in, out] r       - Korzeń drugiego ciągu lub NULL;
+ * @param [in] join         - Odcinek od ostatniego miasta @p l do pierwszego
+ * miasta @p r, zapisywany w ostatnim mieście @p l, jeżeli @p r jest
+ * niepusty.
+ * @return Korzeń połączonego ciągu.
+ */
+rope_node* merge_ropes(object_pool* nodes, rope_node* l, rope_node* r,
+                       Road* join);
+
+/** @brief Zwraca węzeł pierwszego miasta ciągu.
+ * @param [in] t            - Korzeń niepustego ciągu.
+ * @return Węzeł pierwszego miasta.
+ */
+rope_node* rope_first(rope_node* t);
+
+/** @brief Zwraca węzeł ostatniego miasta ciągu.
+ * @param [in] t            - Korzeń niepustego ciągu.
+ * @return Węzeł ostatniego miasta.
+ */
+rope_node* rope_last(rope_node* t);
+
+/** @brief Zwraca węzeł miasta o podanym numerze.
+ * @param [in] t            - Korzeń ciągu;
+ * @param [in] i            - Numer miasta, mniejszy od @ref rope_size (@p t).
+ * @return Węzeł miasta.
+ */
+rope_node* rope_at(rope_node* t, size_t i);
+
+/** @brief Znajduje miasto o podanej etykiecie.
+ * @param [in] t            - Korzeń ciągu;
+ * @param [in] label        - Etykieta miasta leżącego w ciągu;
+ * @param [out] position    - Numer znalezionego miasta w ciągu.
+ * @return Węzeł znalezionego miasta.
+ */
+rope_node* find_label(rope_node* t, unsigned long long label,
+                      size_t* position);
+
+/** @brief Nadaje miastom ciągu etykiety równo od siebie oddalone.
+ * Przejmuje wskazanie na @p t. Kopiuje co najwyżej @ref rope_size (@p t)
+ * węzłów.
+ * @param [in, out] nodes   - Pula węzłów z zarezerwowanym miejscem na kopie;
+ * @param [in, out] t       - Korzeń ciągu;
+ * @param [in, out] label   - Etykieta pierwszego miasta; zostaje przesunięta
+ * za ostatnie miasto;
+ * @param [in] step         - Odstęp pomiędzy etykietami.
+ * @return Korzeń ciągu z nowymi etykietami.
+ */
+rope_node* relabel_rope(object_pool* nodes, rope_node* t,
+                        unsigned long long* label, unsigned long long step);
+
+/** @brief Odwiedza węzły ciągu w kolejności miast.
+ * @param [in] t            - Korzeń ciągu lub NULL;
+ * @param [in] visit        - Funkcja wywoływana dla kolejnych węzłów;
+ * @param [in, out] arg     - Dane przekazywane do @p visit.
+ */
+void walk_rope(rope_node* t, rope_visitor visit, void* arg);
+
+#endif //DROGI_ROUTE_ROPE_H
@@ -0,0 +1,139 @@
+#include "search_workspace.h"
+#include <stdlib.h>
+#include <string.h>
+
+search_workspace* new_search_workspace(void) {
+    search_workspace* ws = (search_workspace*)malloc(sizeof(search_workspace));
+    if (!ws)
+        return NULL;
+
+    ws->capacity = 0;
+    ws->epoch = 0;
+    ws->reached = NULL;
+    ws->settled = NULL;
+    ws->excluded = NULL;
+    ws->previous_city = NULL;
+    ws->only_one_path = NULL;
+    ws->length = NULL;
+    ws->repair = NULL;
+    ws->reached_back = NULL;
+    ws->settled_back = NULL;
+    ws->length_back = NULL;
+    ws->queue = NULL;
+    ws->queue_back = NULL;
+    ws->mode = SEARCH_BIDIRECTIONAL;
+    ws->max_length = 0;
+    ws->workers = NULL;
+    ws->work = 0;
+    ws->out_of_memory = false;
+
+    return ws;
+}
+
+/* Zwalnia tablice i kolejki pamięci roboczej, nie zwalnia samej struktury. */
+static void free_arrays(search_workspace* ws) {
+    free(ws->reached);
+    free(ws->settled);
+    free(ws->excluded);
+    free(ws->previous_city);
+    free(ws->only_one_path);
+    free(ws->length);
+    free(ws->repair);
+    free(ws->reached_back);
+    free(ws->settled_back);
+    free(ws->length_back);
+    free_priority_queue(ws->queue);
+    free_priority_queue(ws->queue_back);
+}
+
+void free_search_workspace(search_workspace* ws) {
+    if (!ws)
+        return;
+
+    free_arrays(ws);
+    free(ws);
+}
+
+bool reserve_search_workspace(search_workspace* ws, size_t n_of_cities) {
+    if (n_of_cities <= ws->capacity)
+        return true;
+
+    size_t capacity = 2 * ws->capacity;
+    if (capacity < n_of_cities)
+        capacity = n_of_cities;
+
+    search_workspace bigger;
+    bigger.reached = (unsigned*)calloc(capacity, sizeof(unsigned));
+    bigger.settled = (unsigned*)calloc(capacity, sizeof(unsigned));
+    bigger.excluded = (unsigned*)calloc(capacity, sizeof(unsigned));
+    bigger.previous_city = (City**)malloc(capacity * sizeof(City*));
+    bigger.only_one_path = (bool*)malloc(capacity * sizeof(bool));
+    bigger.length = (unsigned*)malloc(capacity * sizeof(unsigned));
+    bigger.repair = (int*)malloc(capacity * sizeof(int));
+    bigger.reached_back = (unsigned*)calloc(capacity, sizeof(unsigned));
+    bigger.settled_back = (unsigned*)calloc(capacity, sizeof(unsigned));
+    bigger.length_back = (unsigned*)malloc(capacity * sizeof(unsigned));
+    bigger.queue = make_priority_queue(capacity);
+    bigger.queue_back = make_priority_queue(capacity);
+
+    if (!bigger.reached || !bigger.settled || !bigger.excluded ||
+        !bigger.previous_city || !bigger.only_one_path || !bigger.length ||
+        !bigger.repair || !bigger.reached_back || !bigger.settled_back ||
+        !bigger.length_back || !bigger.queue || !bigger.queue_back) {
+        free_arrays(&bigger);
+        return false;
+    }
+
+    free_arrays(ws);
+
+    ws->capacity = capacity;
+    ws->epoch = 0;
+    ws->reached = bigger.reached;
+    ws->settled = bigger.settled;
+    ws->excluded = bigger.excluded;
+    ws->previous_city = bigger.previous_city;
+    ws->only_one_path = bigger.only_one_path;
+    ws->length = bigger.length;
+    ws->repair = bigger.repair;
+    ws->reached_back = bigger.reached_back;
+    ws->settled_back = bigger.settled_back;
+    ws->length_back = bigger.length_back;
+    ws->queue = bigger.queue;
+    ws->queue_back = bigger.queue_back;
+
+    return true;
+}
+
+void begin_search(search_workspace* ws) {
+    clear_priority_queue(ws->queue);
+    clear_priority_queue(ws->queue_back);
+    tune_priority_queue(ws->queue, ws->max_length);
+    tune_priority_queue(ws->queue_back, ws->max_length);
+    ws->epoch++;
+    ws->out_of_memory = false;
+
+    /* Po przekręceniu licznika stare znaczniki mogłyby wyglądać na aktualne. */
+    if (ws->epoch == 0) {
+        memset(ws->reached, 0, ws->capacity * sizeof(unsigned));
+        memset(ws->settled, 0, ws->capacity * sizeof(unsigned));
+        memset(ws->excluded, 0, ws->capacity * sizeof(unsigned));
+        memset(ws->reached_back, 0, ws->capacity * sizeof(unsigned));
+        memset(ws->settled_back, 0, ws->capacity * sizeof(unsigned));
+        ws->epoch = 1;
+    }
+}
+
+static void exclude_city(void* arg, City* city) {
+    search_workspace* ws = (search_workspace*)arg;
+
+    ws->excluded[city->city_id] = ws->epoch;
+}
+
+void exclude_route(search_workspace* ws, national_route* route) {
+    if (route)
+        route_walk(route, exclude_city, ws);
+}
+
+bool is_excluded(search_workspace* ws, City* city) {
+    return ws->excluded[city->city_id] == ws->epoch;
+}
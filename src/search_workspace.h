@@ -0,0 +1,115 @@
+/** @file
+ * Biblioteka definiująca pamięć roboczą wyszukiwania optymalnych dróg,
+ * używaną wielokrotnie przez kolejne wyszukiwania.
+ */
+
+#ifndef DROGI_SEARCH_WORKSPACE_H
+#define DROGI_SEARCH_WORKSPACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "specifications.h"
+#include "priority_queue.h"
+#include "list.h"
+#include "national_route.h"
+#include "worker_pool.h"
+
+/** @brief Sposób wyszukiwania optymalnych dróg.
+ */
+typedef enum search_mode {
+    SEARCH_DIJKSTRA, ///< Algorytm Dijkstry z miasta początkowego
+    SEARCH_BIDIRECTIONAL, ///< Algorytm Dijkstry z obu końców drogi
+    SEARCH_CONTRACTION, ///< Hierarchia skrótów, o ile droga nie omija miast
+    SEARCH_LANDMARKS, ///< Algorytm A* z ograniczeniami od miast orientacyjnych
+    SEARCH_PARALLEL ///< Algorytm delta-stepping wykonywany przez wiele wątków
+} search_mode;
+
+/** @brief Typ danych przechowujący pamięć roboczą wyszukiwania dróg.
+ * Tablice indeksowane są numerami Id miast. Wpis w tablicy @p previous_city
+ * lub @p only_one_path jest ważny tylko wtedy, gdy odpowiadający mu wpis
+ * w @p reached jest równy @p epoch, a miasto jest odwiedzone, gdy wpis w
+ * @p settled jest równy @p epoch. Dzięki temu rozpoczęcie nowego
+ * wyszukiwania wymaga jedynie zwiększenia @p epoch. Tablice z przyrostkiem
+ * @p back opisują wyszukiwanie od miasta końcowego w trybie
+ * @ref SEARCH_BIDIRECTIONAL.
+ */
+typedef struct search_workspace {
+    size_t capacity; ///< Liczba miast, dla których zaalokowano tablice
+    unsigned epoch; ///< Numer bieżącego wyszukiwania
+    unsigned* reached; ///< Numer wyszukiwania, w którym dotarto do miasta
+    unsigned* settled; ///< Numer wyszukiwania, w którym odwiedzono miasto
+    unsigned* excluded; ///< Numer wyszukiwania, z którego wykluczono miasto
+    City** previous_city; ///< Miasto poprzedzające na najlepszej drodze
+    bool* only_one_path; ///< Czy najlepsza droga do miasta jest jedyna
+    unsigned* length; ///< Długość najlepszej drogi do miasta
+    int* repair; ///< Rok remontu najstarszego odcinka najlepszej drogi
+    ///< do miasta, używany w trybie @ref SEARCH_CONTRACTION i przez
+    ///< @ref search_targets
+    unsigned* reached_back; ///< Numer wyszukiwania, w którym dotarto do
+    ///< miasta od miasta końcowego, a w @ref search_targets numer
+    ///< wyszukiwania, w którym miasto jest nieodwiedzonym miastem docelowym
+    unsigned* settled_back; ///< Numer wyszukiwania, w którym odwiedzono
+    ///< miasto od miasta końcowego
+    unsigned* length_back; ///< Długość najkrótszej drogi z miasta do miasta
+    ///< końcowego
+    priority_queue* queue; ///< Kolejka priorytetowa wyszukiwania
+    priority_queue* queue_back; ///< Kolejka wyszukiwania od miasta końcowego
+    search_mode mode; ///< Sposób wyszukiwania używany przez find_path
+    unsigned max_length; ///< Długość najdłuższego odcinka drogi dodanego
+    ///< do mapy lub 0, według której @ref begin_search dobiera sposób
+    ///< przechowywania elementów kolejek
+    worker_pool* workers; ///< Pula wątków, której może użyć bieżące
+    ///< wyszukiwanie w trybie @ref SEARCH_PARALLEL, lub NULL
+    size_t work; ///< Liczba przejrzanych miast i odcinków we wszystkich
+    ///< wyszukiwaniach od ostatniego wyzerowania
+    bool out_of_memory; ///< Czy ostatnie wyszukiwanie nie powiodło się
+    ///< z braku pamięci, a nie z braku jednoznacznej drogi
+} search_workspace;
+
+/** @brief Tworzy nową, pustą pamięć roboczą.
+ * @return Zwraca wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+search_workspace* new_search_workspace(void);
+
+/** @brief Usuwa pamięć roboczą.
+ * Nic nie robi, jeżeli @p ws ma wartość NULL.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą.
+ */
+void free_search_workspace(search_workspace* ws);
+
+/** @brief Zapewnia miejsce dla podanej liczby miast.
+ * Powiększa tablice pamięci roboczej, jeżeli są za małe dla
+ * @p n_of_cities miast. Nic nie robi w przeciwnym wypadku.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą;
+ * @param [in] n_of_cities  - Liczba miast.
+ * @return Zwraca @p true jeżeli pamięć robocza mieści @p n_of_cities miast,
+ * @p false jeżeli nie udało się zaalokować pamięci.
+ */
+bool reserve_search_workspace(search_workspace* ws, size_t n_of_cities);
+
+/** @brief Rozpoczyna nowe wyszukiwanie.
+ * Unieważnia w czasie stałym wszystkie dane poprzedniego wyszukiwania
+ * i dobiera sposób przechowywania elementów kolejek do @p max_length.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą.
+ */
+void begin_search(search_workspace* ws);
+
+/** @brief Wyklucza z bieżącego wyszukiwania miasta leżące na drodze.
+ * Oznacza w pamięci roboczej wszystkie miasta drogi @p route, a jeżeli
+ * droga ma wersję roboczą, to miasta wersji roboczej, dzięki czemu
+ * sprawdzenie, czy miasto leży na tej drodze, zajmuje czas stały.
+ * @param [in, out] ws      - Wskaźnik na pamięć roboczą;
+ * @param [in] route        - Droga krajowa lub NULL.
+ */
+void exclude_route(search_workspace* ws, national_route* route);
+
+/** @brief Sprawdza, czy miasto jest wykluczone z bieżącego wyszukiwania.
+ * @param [in] ws           - Wskaźnik na pamięć roboczą;
+ * @param [in] city         - Wskaźnik na strukturę reprezentującą miasto.
+ * @return Zwraca @p true jeżeli @p city zostało wykluczone przez
+ * @ref exclude_route od początku bieżącego wyszukiwania.
+ */
+bool is_excluded(search_workspace* ws, City* city);
+
+#endif //DROGI_SEARCH_WORKSPACE_H
@@ -3,6 +3,10 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
+
+/** Liczba odcinków wychodzących z miasta, od której budowany jest indeks. */
+#define ROAD_INDEX_THRESHOLD 8
 
 size_t int_length(int d) {
     int length = (d < 0) ? 1 : 0;
@@ -38,26 +42,197 @@ char* int_to_string(int d) {
     return string;
 }
 
-City* newCity(const char* city, unsigned city_id) {
-    City* c = (City*)malloc(sizeof(City));
+void init_graph_memory(graph_memory* memory) {
+    init_object_pool(&memory->cities, sizeof(City));
+    init_object_pool(&memory->roads, sizeof(Road));
+    init_object_pool(&memory->road_lists, sizeof(road_list));
+    init_string_pool(&memory->names);
+}
+
+void release_graph_memory(graph_memory* memory) {
+    release_object_pool(&memory->cities);
+    release_object_pool(&memory->roads);
+    release_object_pool(&memory->road_lists);
+    release_string_pool(&memory->names);
+}
+
+City* newCity(graph_memory* memory, const char* city, size_t n,
+              unsigned city_id) {
+    City* c = (City*)pool_alloc(&memory->cities);
     if (!c)
         return NULL;
 
     c->roads = NULL;
-    size_t n = strlen(city);
-    c->city_name = (char*)malloc(n * sizeof(char) + 1);
-
-    for (size_t i = 0; i < n; i++)
-        c->city_name[i] = city[i];
+    c->n_of_roads = 0;
+    c->index = NULL;
 
-    c->city_name[n] = '\0';
+    if (n < SHORT_NAME_SIZE) {
+        memcpy(c->short_name, city, n + 1);
+        c->city_name = c->short_name;
+    }
+    else {
+        c->city_name = pool_strdup(&memory->names, city, n);
+        if (!c->city_name) {
+            pool_free(&memory->cities, c);
+            return NULL;
+        }
+    }
 
+    c->name_length = n;
+    c->name_hash = 0;
     c->city_id = city_id;
     return c;
 }
 
-road_list* newRoadList(Road* r) {
-    road_list* rl = (road_list*)malloc(sizeof(road_list));
+static City* other_city(Road* road, City* city) {
+    return (road->city1 == city) ? road->city2 : road->city1;
+}
+
+static size_t index_slot(road_index* index, unsigned neighbour) {
+    uint64_t h = (uint64_t)neighbour * UINT64_C(0x9E3779B97F4A7C15);
+    return (size_t)(h >> 32) & (index->capacity - 1);
+}
+
+static void free_road_index(road_index* index) {
+    if (!index)
+        return;
+
+    free(index->neighbour);
+    free(index->slots);
+    free(index);
+}
+
+static void index_insert(road_index* index, City* city, road_list* rl) {
+    unsigned neighbour = other_city(rl->road, city)->city_id;
+    size_t x = index_slot(index, neighbour);
+
+    while (index->slots[x])
+        x = (x + 1) & (index->capacity - 1);
+
+    index->neighbour[x] = neighbour;
+    index->slots[x] = rl;
+}
+
+/* Buduje indeks od nowa z listy odcinków miasta. Jeżeli nie uda się
+ * zaalokować pamięci, miasto zostaje bez indeksu i odcinki są wyszukiwane
+ * w liście. */
+static void rebuild_road_index(City* city) {
+    free_road_index(city->index);
+    city->index = NULL;
+
+    road_index* index = (road_index*)malloc(sizeof(road_index));
+    if (!index)
+        return;
+
+    index->capacity = 2 * ROAD_INDEX_THRESHOLD;
+    while (index->capacity < 2 * city->n_of_roads)
+        index->capacity *= 2;
+
+    index->neighbour = (unsigned*)malloc(index->capacity * sizeof(unsigned));
+    index->slots = (road_list**)calloc(index->capacity, sizeof(road_list*));
+    if (!index->neighbour || !index->slots) {
+        free_road_index(index);
+        return;
+    }
+
+    for (road_list* rl = city->roads; rl; rl = rl->next_road)
+        index_insert(index, city, rl);
+
+    city->index = index;
+}
+
+static road_list* index_find(road_index* index, unsigned neighbour) {
+    size_t x = index_slot(index, neighbour);
+
+    while (index->slots[x]) {
+        if (index->neighbour[x] == neighbour)
+            return index->slots[x];
+
+        x = (x + 1) & (index->capacity - 1);
+    }
+
+    return NULL;
+}
+
+static void index_remove(road_index* index, unsigned neighbour) {
+    size_t mask = index->capacity - 1;
+    size_t x = index_slot(index, neighbour);
+
+    while (index->slots[x] && index->neighbour[x] != neighbour)
+        x = (x + 1) & mask;
+
+    if (!index->slots[x])
+        return;
+
+    /* Przesuwamy wstecz kolejne elementy, żeby nie zostawiać dziur
+     * w ciągach sondowania. */
+    size_t y = x;
+    while (true) {
+        y = (y + 1) & mask;
+        if (!index->slots[y])
+            break;
+
+        size_t home = index_slot(index, index->neighbour[y]);
+        if (((y - home) & mask) >= ((y - x) & mask)) {
+            index->neighbour[x] = index->neighbour[y];
+            index->slots[x] = index->slots[y];
+            x = y;
+        }
+    }
+
+    index->slots[x] = NULL;
+}
+
+static void link_road_list(City* city, road_list* rl) {
+    rl->prev_road = NULL;
+    rl->next_road = city->roads;
+    if (city->roads)
+        city->roads->prev_road = rl;
+    city->roads = rl;
+
+    city->n_of_roads++;
+    if (city->index && 2 * city->n_of_roads <= city->index->capacity)
+        index_insert(city->index, city, rl);
+    else if (city->n_of_roads >= ROAD_INDEX_THRESHOLD)
+        rebuild_road_index(city);
+}
+
+static void unlink_road_list(City* city, road_list* rl) {
+    if (rl->prev_road)
+        rl->prev_road->next_road = rl->next_road;
+    else
+        city->roads = rl->next_road;
+
+    if (rl->next_road)
+        rl->next_road->prev_road = rl->prev_road;
+
+    city->n_of_roads--;
+    if (city->index) {
+        if (city->n_of_roads < ROAD_INDEX_THRESHOLD / 2) {
+            free_road_index(city->index);
+            city->index = NULL;
+        }
+        else {
+            index_remove(city->index, other_city(rl->road, city)->city_id);
+        }
+    }
+}
+
+void free_city_data(City* city) {
+    free_road_index(city->index);
+    city->index = NULL;
+}
+
+void free_city(graph_memory* memory, City* city) {
+    if (!city)
+        return;
+
+    free_city_data(city);
+    pool_free(&memory->cities, city);
+}
+
+road_list* newRoadList(graph_memory* memory, Road* r) {
+    road_list* rl = (road_list*)pool_alloc(&memory->road_lists);
     if (!rl)
         return NULL;
 
@@ -68,17 +243,17 @@ road_list* newRoadList(Road* r) {
     return rl;
 }
 
-void free_road_list(road_list* rl) {
-    if (!rl)
-        return;
+void free_road_list(graph_memory* memory, road_list* rl) {
+    pool_free(&memory->road_lists, rl);
+}
 
-    rl->prev_road = NULL;
-    rl->next_road = NULL;
-    free(rl);
+void free_road(graph_memory* memory, Road* road) {
+    pool_free(&memory->roads, road);
 }
 
-bool newRoad(City* city1, City* city2, unsigned length, int repairYear) {
-    Road* r = (Road*)malloc(sizeof(Road));
+bool newRoad(graph_memory* memory, City* city1, City* city2,
+             unsigned length, int repairYear) {
+    Road* r = (Road*)pool_alloc(&memory->roads);
 
     if (!r)
         return false;
@@ -87,38 +262,29 @@ bool newRoad(City* city1, City* city2, unsigned length, int repairYear) {
     r->city1 = city1;
     r->city2 = city2;
     r->repairYear = repairYear;
+    r->routes = NULL;
 
-    road_list* rl1 = city1->roads;
-    road_list* rl2 = city2->roads;
-    road_list* new_rl1 = newRoadList(r);
-    road_list* new_rl2 = newRoadList(r);
-
-    if (!new_rl1 || !new_rl2) {
-        free_road_list(new_rl1);
-        free_road_list(new_rl2);
+    if (!attach_road(memory, r)) {
+        free_road(memory, r);
         return false;
     }
 
-    if (!rl1) {
-        //rl1 = new_rl;
-        city1->roads = new_rl1;
-    }
-    else {
-        new_rl1->next_road = rl1;
-        rl1->prev_road = new_rl1;
-        city1->roads = new_rl1;
-    }
+    return true;
+}
 
-    if (!rl2) {
-       // rl2 = new_rl;
-       city2->roads = new_rl2;
-    }
-    else {
-        new_rl2->next_road = rl2;
-        rl2->prev_road = new_rl2;
-        city2->roads = new_rl2;
+bool attach_road(graph_memory* memory, Road* road) {
+    road_list* new_rl1 = newRoadList(memory, road);
+    road_list* new_rl2 = newRoadList(memory, road);
+
+    if (!new_rl1 || !new_rl2) {
+        free_road_list(memory, new_rl1);
+        free_road_list(memory, new_rl2);
+        return false;
     }
 
+    link_road_list(road->city1, new_rl1);
+    link_road_list(road->city2, new_rl2);
+
     return true;
 }
 
@@ -126,31 +292,13 @@ bool areConnected(City* city1, City* city2) {
     if (!city1 || !city2)
         return false;
 
-    road_list* rl = city1->roads;
-
-    while (rl) {
-        Road* r = rl->road;
-
-        if (r->city1 == city2 || r->city2 == city2)
-            return true;
-
-        rl = rl->next_road;
-    }
-
-    return false;
+    return get_road_list(city1, city2) != NULL;
 }
 
 Road* getRoad(City* city1, City* city2) {
-    road_list* rl = city1->roads;
-
-    while(rl) {
-        if (rl->road->city1 == city2 || rl->road->city2 == city2)
-            return rl->road;
-
-        rl = rl->next_road;
-    }
+    road_list* rl = get_road_list(city1, city2);
 
-    return NULL;
+    return rl ? rl->road : NULL;
 }
 
 void changeRepairYear(City* city1, City* city2, int repairYear) {
@@ -159,6 +307,9 @@ void changeRepairYear(City* city1, City* city2, int repairYear) {
 }
 
 road_list* get_road_list(City* c1, City* c2) {
+    if (c1->index)
+        return index_find(c1->index, c2->city_id);
+
     road_list* rl = c1->roads;
 
     while (rl) {
@@ -171,51 +322,16 @@ road_list* get_road_list(City* c1, City* c2) {
     return NULL;
 }
 
-road_list* first_road_list(road_list* rl) {
-    if (!rl)
-        return NULL;
-
-    while (rl->prev_road)
-        rl = rl->prev_road;
-
-    return rl;
-}
-
-Road* remove_road(City* c1, City* c2) {
-    Road* road = getRoad(c1, c2);
-
-
+Road* remove_road(graph_memory* memory, City* c1, City* c2) {
     road_list* rl1 = get_road_list(c1, c2);
     road_list* rl2 = get_road_list(c2, c1);
+    Road* road = rl1->road;
 
-    if (rl1->prev_road) {
-        rl1->prev_road->next_road = rl1->next_road;
-        c1->roads = rl1->prev_road;
-    }
-    if (rl1->next_road) {
-        rl1->next_road->prev_road = rl1->prev_road;
-        c1->roads = rl1->next_road;
-    }
+    unlink_road_list(c1, rl1);
+    unlink_road_list(c2, rl2);
 
-    if (rl2->prev_road) {
-        rl2->prev_road->next_road = rl2->next_road;
-        c2->roads = rl2->prev_road;
-    }
-    if (rl2->next_road) {
-        rl2->next_road->prev_road = rl2->prev_road;
-        c2->roads = rl2->next_road;
-    }
-
-    if (!rl1->next_road && !rl1->prev_road)
-        c1->roads = NULL;
-    if (!rl2->next_road && !rl2->prev_road)
-        c2->roads = NULL;
-
-    c1->roads = first_road_list(c1->roads);
-    c2->roads = first_road_list(c2->roads);
-
-    free_road_list(rl1);
-    free_road_list(rl2);
+    free_road_list(memory, rl1);
+    free_road_list(memory, rl2);
 
     return road;
-}
\ No newline at end of file
+}
@@ -9,13 +9,22 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "object_pool.h"
+#include "string_pool.h"
 
 struct City;
 /** @brief Typ danych przechowujący inforamcje o mieście.
  * @var City::city_id - Numer Id miasta.
- * @var City::city_name - Wskaźnik na napis będący nazwą miasta.
+ * @var City::city_name - Wskaźnik na napis będący nazwą miasta. Krótkie
+ * nazwy przechowywane są w samej strukturze, dłuższe w puli napisów mapy.
+ * @var City::name_length - Długość nazwy miasta.
+ * @var City::name_hash - Hasz nazwy miasta.
+ * @var City::short_name - Miejsce na krótką nazwę miasta.
  * @var City::road_list - Wskaźnik na element listy zawierającej
  * odcinki wychodzące z tego miasta.
+ * @var City::n_of_roads - Liczba odcinków wychodzących z tego miasta.
+ * @var City::index - Wskaźnik na indeks odcinków wychodzących z tego
+ * miasta lub NULL, jeżeli jest ich niewiele.
  */
 typedef struct City City;
 
@@ -25,6 +34,8 @@ struct Road;
  * @var Road::repair - Ostatni czas remontu lub budowy odcinka drogi.
  * @var Road::city1  - Miasto, z którego wychodzi ten odcinek.
  * @bar Road::city2  - Drugie miasto, którego wychodzi ten odcinek.
+ * @var Road::routes - Pierwszy wpis listy dróg krajowych przechodzących
+ * przez ten odcinek lub NULL.
  */
 typedef struct Road Road;
 
@@ -37,12 +48,27 @@ struct road_list;
  */
 typedef struct road_list road_list;
 
+struct road_index;
+/** @brief Typ danych przechowujący indeks odcinków drogi wychodzących
+ * z jednego miasta.
+ * Tablica haszująca z adresowaniem otwartym, której kluczami są numery Id
+ * sąsiednich miast, a wartościami elementy listy odcinków drogi.
+ * @var road_index::capacity - Liczba miejsc w tablicy, potęga dwójki.
+ * @var road_index::neighbour - Numery Id sąsiadów w kolejnych miejscach.
+ * @var road_index::slots - Elementy listy odcinków w kolejnych miejscach,
+ * NULL oznacza wolne miejsce.
+ */
+typedef struct road_index road_index;
+
+
+struct route_use;
 
 struct Road {
     unsigned length;
     int repairYear;
     City* city1;
     City* city2;
+    struct route_use* routes;
 };
 
 struct road_list {
@@ -51,10 +77,35 @@ struct road_list {
     road_list* prev_road;
 };
 
+/** @brief Typ danych przechowujący pule, z których przydzielane są miasta,
+ * odcinki drogi i elementy list odcinków jednej mapy.
+ */
+typedef struct graph_memory {
+    object_pool cities; ///< Pula struktur miast
+    object_pool roads; ///< Pula odcinków drogi
+    object_pool road_lists; ///< Pula elementów list odcinków drogi
+    string_pool names; ///< Pula długich nazw miast
+} graph_memory;
+
+struct road_index {
+    size_t capacity;
+    unsigned* neighbour;
+    road_list** slots;
+};
+
+/** Rozmiar miejsca na nazwę miasta w strukturze miasta, razem ze znakiem
+ * końca napisu. */
+#define SHORT_NAME_SIZE 16
+
 struct City {
     unsigned city_id;
+    unsigned name_length;
+    size_t name_hash;
     char* city_name;
     road_list* roads;
+    size_t n_of_roads;
+    road_index* index;
+    char short_name[SHORT_NAME_SIZE];
 };
 
 /** @brief Zwraca liczbę cyfr liczby @p d, dodaje jeden jeżeli jest ujemna.
@@ -92,13 +143,15 @@ road_list* get_road_list(City* city1, City* city2);
 
 /** @brief Usuwa odcinek drogi pomiędzy @p c1 i @p c2.
  *  Usuwa odcinek drogi pomiędzu @p c1 i @p c2 z list wychodzących odcinków dróg
- *  obu miast. Nic nie robi, jeżeli nie istnieje taki odcinek.
+ *  obu miast. Nic nie robi, jeżeli nie istnieje taki odcinek. Sam odcinek
+ *  należy zwolnić za pomocą @ref free_road.
+ * @param [in, out] memory - Pule pamięci mapy;
  * @param [in] city1    - Wskaźnik na strukturę reprezentującą miasto.
  * @param [in] city2    - Wskaźnik na strukturę reprezentującą miasto.
  * @return Zwraca wskaźnik na usunięty odcinek drogi, lub NULL, jeżeli ten odcinek
  * nie istniał.
  */
-Road* remove_road(City* c1, City* c2);
+Road* remove_road(graph_memory* memory, City* c1, City* c2);
 
 /**@brief Sprawdza, czy istnieje odcinek drogi pomiędzy miastami @p city1 i @p city2.
  *
@@ -111,30 +164,68 @@ bool areConnected(City* city1, City* city2);
 
 /** @Brief Tworzy nowy element typu @c road_list, zawierający odcienk
  * drogi @p road.
+ * @param [in, out] memory - Pule pamięci mapy;
  * @param [in] road     - Odcinek drogi.
  * @return Zwraca wskaźnik na nowo utworzony element. Jeżeli alokacja
  * pamięci się nie powiodła, to zwraca NULL.
  */
-road_list* newRoadList(Road* road);
+road_list* newRoadList(graph_memory* memory, Road* road);
 
-/** @brief Usuwa z pamięci listę odcinków drogi.
- * Usuwa i zwalnia pamięć z całej listy odcinków dróg oraz samych
- * odcinków dróg zawartych w tej liście.
- * @param [in, out] rl  - Lista odcinków dróg.
+/** @brief Usuwa z pamięci element listy odcinków drogi.
+ * Oddaje element @p rl do puli. Nie zwalnia zawartego w nim odcinka drogi.
+ * @param [in, out] memory - Pule pamięci mapy;
+ * @param [in, out] rl  - Element listy odcinków dróg.
  */
-void free_road_list(road_list* rl);
+void free_road_list(graph_memory* memory, road_list* rl);
+
+/** @brief Usuwa z pamięci odcinek drogi.
+ * @param [in, out] memory - Pule pamięci mapy;
+ * @param [in, out] road   - Odcinek drogi zwrócony przez @ref remove_road.
+ */
+void free_road(graph_memory* memory, Road* road);
+
+/** @brief Inicjalizuje puste pule pamięci mapy.
+ * @param [out] memory  - Pule pamięci mapy.
+ */
+void init_graph_memory(graph_memory* memory);
+
+/** @brief Zwalnia naraz wszystkie miasta, ich nazwy, odcinki i listy
+ * odcinków mapy. Indeksy odcinków trzeba zwolnić wcześniej.
+ * @param [in, out] memory - Pule pamięci mapy.
+ */
+void release_graph_memory(graph_memory* memory);
 
 /** @brief Tworzy struktuę opisującą nowe miasto.
  *
- * @param [in] city     - Nazwa miasta.
+ * @param [in, out] memory - Pule pamięci mapy;
+ * @param [in] city     - Nazwa miasta;
+ * @param [in] length   - Długość nazwy miasta;
  * @param [in] city_id  - Id miasta.
  * @return Zwraca @p true jeżeli udało się stworzyć miasto. Zwraca @p false
  * jeżeli nie udało się zaalokować pamięci.
  */
-City* newCity(const char* city, unsigned city_id);
+City* newCity(graph_memory* memory, const char* city, size_t length,
+              unsigned city_id);
+
+/** @brief Usuwa strukturę opisującą miasto.
+ * Zwalnia pamięć zajmowaną przez miasto i indeks odcinków drogi. Długa nazwa
+ * miasta pozostaje w puli napisów aż do jej zwolnienia.
+ * Nie usuwa odcinków drogi wychodzących z miasta.
+ * @param [in, out] memory  - Pule pamięci mapy;
+ * @param [in, out] city    - Wskaźnik na strukturę reprezentującą miasto.
+ */
+void free_city(graph_memory* memory, City* city);
+
+/** @brief Zwalnia dane miasta przechowywane poza pulami.
+ * Zwalnia indeks odcinków drogi, nie oddaje samej struktury do puli.
+ * Używane przed zwolnieniem wszystkich pul naraz.
+ * @param [in, out] city    - Wskaźnik na strukturę reprezentującą miasto.
+ */
+void free_city_data(City* city);
 
 /** @brief Dodaje odcinek drogi pomiędzy miastami @p city1 i @ city2 o długości
  * @p length i roku budowy @p repairYear.
+ * @param [in, out] memory  - Pule pamięci mapy;
  * @param [in] city1        - Wskaźnik na strukturę reprezentującą miasto.
  * @param [in] city1        - Wskaźnik na strukturę reprezentującą miasto.
  * @param [in] length       - Długość odcinka drogi.
@@ -142,7 +233,19 @@ City* newCity(const char* city, unsigned city_id);
  * @return Zwraca @p true jeżeli udało się dodać i stworzyć odcinek. Zwraca @p false
  * jeżeli nie udało się zaalokować pamięci.
  */
-bool newRoad(City* city1, City* city2, unsigned length, int repairYear);
+bool newRoad(graph_memory* memory, City* city1, City* city2,
+             unsigned length, int repairYear);
+
+/** @brief Dołącza z powrotem do grafu odcinek odłączony przez
+ * @ref remove_road.
+ * Odcinek zachowuje swoje pola, w tym listę przechodzących przez niego
+ * dróg krajowych.
+ * @param [in, out] memory  - Pule pamięci mapy;
+ * @param [in, out] road    - Odcinek drogi zwrócony przez @ref remove_road.
+ * @return Zwraca @p true jeżeli udało się dołączyć odcinek. Zwraca @p false
+ * jeżeli nie udało się zaalokować pamięci.
+ */
+bool attach_road(graph_memory* memory, Road* road);
 
 /** @Brief Zmienia czas remontu odcinka drogi pomiędzy @p city1 a @p city2
  * na @p repairYear.
@@ -0,0 +1,51 @@
+#include "string_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_SIZE 65536
+
+/** @brief Blok pamięci, do którego kopiowane są napisy.
+ */
+struct string_chunk {
+    struct string_chunk* next; ///< Następny blok na liście bloków puli
+    char data[]; ///< Miejsce na napisy
+};
+
+void init_string_pool(string_pool* pool) {
+    pool->chunks = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+}
+
+char* pool_strdup(string_pool* pool, const char* s, size_t length) {
+    if ((size_t)(pool->end - pool->next) < length + 1) {
+        /* Bardzo długie napisy dostają własny blok. */
+        size_t size = (length + 1 > CHUNK_SIZE) ? length + 1 : CHUNK_SIZE;
+        struct string_chunk* chunk =
+                (struct string_chunk*)malloc(sizeof(struct string_chunk) + size);
+        if (!chunk)
+            return NULL;
+
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->next = chunk->data;
+        pool->end = chunk->data + size;
+    }
+
+    char* copy = pool->next;
+    memcpy(copy, s, length);
+    copy[length] = '\0';
+    pool->next += length + 1;
+
+    return copy;
+}
+
+void release_string_pool(string_pool* pool) {
+    while (pool->chunks) {
+        struct string_chunk* chunk = pool->chunks;
+        pool->chunks = chunk->next;
+        free(chunk);
+    }
+
+    init_string_pool(pool);
+}
@@ -0,0 +1,43 @@
+/** @file
+ * Biblioteka implementująca pulę napisów przechowywanych w dużych,
+ * ciągłych blokach pamięci.
+ */
+
+#ifndef DROGI_STRING_POOL_H
+#define DROGI_STRING_POOL_H
+
+#include <stddef.h>
+
+struct string_chunk;
+
+/** @brief Typ danych reprezentujący pulę napisów.
+ * Napisy są kopiowane jeden za drugim do bloków pamięci, które nigdy nie są
+ * przenoszone, więc wskaźniki na napisy pozostają ważne aż do zwolnienia
+ * całej puli.
+ */
+typedef struct string_pool {
+    struct string_chunk* chunks; ///< Lista zaalokowanych bloków
+    char* next; ///< Pierwsze wolne miejsce w bieżącym bloku
+    char* end; ///< Koniec bieżącego bloku
+} string_pool;
+
+/** @brief Inicjalizuje pustą pulę napisów.
+ * @param [out] pool        - Wskaźnik na pulę.
+ */
+void init_string_pool(string_pool* pool);
+
+/** @brief Kopiuje napis do puli.
+ * @param [in, out] pool    - Wskaźnik na pulę;
+ * @param [in] s            - Wskaźnik na napis;
+ * @param [in] length       - Długość napisu @p s.
+ * @return Wskaźnik na kopię napisu zakończoną znakiem @p '\0' lub NULL, gdy
+ * nie udało się zaalokować pamięci.
+ */
+char* pool_strdup(string_pool* pool, const char* s, size_t length);
+
+/** @brief Zwalnia wszystkie napisy z puli.
+ * @param [in, out] pool    - Wskaźnik na pulę.
+ */
+void release_string_pool(string_pool* pool);
+
+#endif //DROGI_STRING_POOL_H
@@ -0,0 +1,150 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "worker_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_DEFAULT_WORKERS 8
+
+/** @brief Dane jednego wątku puli.
+ */
+typedef struct worker {
+    worker_pool* pool; ///< Pula, do której należy wątek
+    size_t id; ///< Numer wątku
+    pthread_t thread; ///< Wątek
+} worker;
+
+struct worker_pool {
+    size_t n_of_workers; ///< Liczba wątków razem z wątkiem wywołującym
+    size_t n_of_threads; ///< Liczba uruchomionych wątków puli
+    worker* workers; ///< Wątki puli, o numerach od 1
+    pthread_mutex_t mutex; ///< Chroni pozostałe pola
+    pthread_cond_t start; ///< Sygnalizuje nowe zadania lub zakończenie
+    pthread_cond_t done; ///< Sygnalizuje, że wątki skończyły zadania
+    size_t generation; ///< Numer bieżącej partii zadań
+    pool_task task; ///< Funkcja wykonująca zadanie
+    void* arg; ///< Dane przekazywane do funkcji
+    size_t n_of_tasks; ///< Liczba zadań w partii
+    size_t next_task; ///< Numer następnego niewziętego zadania
+    size_t active; ///< Liczba wątków puli pracujących nad partią
+    bool stop; ///< Czy wątki mają się zakończyć
+};
+
+size_t default_worker_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (n < 1)
+        return 1;
+
+    return (n < MAX_DEFAULT_WORKERS) ? (size_t)n : MAX_DEFAULT_WORKERS;
+}
+
+/* Wykonuje zadania bieżącej partii, dopóki jakieś zostały. Wywoływana
+ * z zablokowanym muteksem, który zwalnia na czas wykonania zadania. */
+static void take_tasks(worker_pool* pool, size_t id) {
+    while (pool->next_task < pool->n_of_tasks) {
+        size_t task = pool->next_task++;
+
+        pthread_mutex_unlock(&pool->mutex);
+        pool->task(pool->arg, id, task);
+        pthread_mutex_lock(&pool->mutex);
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker* w = (worker*)arg;
+    worker_pool* pool = w->pool;
+    size_t generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->stop && pool->generation == generation)
+            pthread_cond_wait(&pool->start, &pool->mutex);
+
+        if (pool->stop)
+            break;
+
+        generation = pool->generation;
+        take_tasks(pool, w->id);
+
+        if (--pool->active == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+worker_pool* new_worker_pool(size_t n_of_workers) {
+    worker_pool* pool = (worker_pool*)calloc(1, sizeof(worker_pool));
+    if (!pool)
+        return NULL;
+
+    pool->n_of_workers = n_of_workers;
+    pool->workers = (worker*)malloc(n_of_workers * sizeof(worker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (size_t i = 1; i < n_of_workers; i++) {
+        worker* w = &pool->workers[i];
+        w->pool = pool;
+        w->id = i;
+
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            free_worker_pool(pool);
+            return NULL;
+        }
+
+        pool->n_of_threads++;
+    }
+
+    return pool;
+}
+
+void free_worker_pool(worker_pool* pool) {
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 1; i <= pool->n_of_threads; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t worker_count(worker_pool* pool) {
+    return pool->n_of_workers;
+}
+
+void run_tasks(worker_pool* pool, pool_task task, void* arg,
+               size_t n_of_tasks) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->arg = arg;
+    pool->n_of_tasks = n_of_tasks;
+    pool->next_task = 0;
+    pool->active = pool->n_of_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    take_tasks(pool, 0);
+
+    while (pool->active > 0)
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,62 @@
+/** @file
+ * Biblioteka implementująca stałą pulę wątków wykonujących równolegle
+ * niezależne zadania.
+ */
+
+#ifndef DROGI_WORKER_POOL_H
+#define DROGI_WORKER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief Typ funkcji wykonującej jedno zadanie.
+ * @param [in, out] arg     - Dane wspólne dla wszystkich zadań;
+ * @param [in] worker       - Numer wątku wykonującego zadanie, od 0 do
+ * liczby wątków puli bez jednego;
+ * @param [in] task         - Numer zadania.
+ */
+typedef void (*pool_task)(void* arg, size_t worker, size_t task);
+
+struct worker_pool;
+/** @brief Typ danych reprezentujący pulę wątków.
+ * Wątek wywołujący @ref run_tasks też wykonuje zadania, jako wątek
+ * o numerze 0.
+ */
+typedef struct worker_pool worker_pool;
+
+/** @brief Zwraca domyślną liczbę wątków puli.
+ * @return Liczba dostępnych procesorów, nie większa niż 8.
+ */
+size_t default_worker_count(void);
+
+/** @brief Tworzy pulę wątków.
+ * @param [in] n_of_workers - Liczba wątków razem z wątkiem wywołującym,
+ * co najmniej 2.
+ * @return Zwraca wskaźnik na pulę lub NULL, gdy nie udało się zaalokować
+ * pamięci lub utworzyć wątków.
+ */
+worker_pool* new_worker_pool(size_t n_of_workers);
+
+/** @brief Kończy wątki puli i ją usuwa.
+ * Nic nie robi, jeżeli @p pool ma wartość NULL.
+ * @param [in, out] pool    - Wskaźnik na pulę.
+ */
+void free_worker_pool(worker_pool* pool);
+
+/** @brief Zwraca liczbę wątków puli razem z wątkiem wywołującym.
+ * @param [in] pool         - Wskaźnik na pulę.
+ * @return Liczba wątków.
+ */
+size_t worker_count(worker_pool* pool);
+
+/** @brief Wykonuje zadania o numerach od 0 do @p n_of_tasks - 1.
+ * Kończy się, gdy wszystkie zadania zostały wykonane.
+ * @param [in, out] pool    - Wskaźnik na pulę;
+ * @param [in] task         - Funkcja wykonująca zadanie;
+ * @param [in, out] arg     - Dane przekazywane do @p task;
+ * @param [in] n_of_tasks   - Liczba zadań.
+ */
+void run_tasks(worker_pool* pool, pool_task task, void* arg,
+               size_t n_of_tasks);
+
+#endif //DROGI_WORKER_POOL_H